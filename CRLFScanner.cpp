@@ -0,0 +1,30 @@
+/**
+ * @file CRLFScanner.cpp
+ * @brief CRLF delimiter scanner implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "CRLFScanner.hpp"
+
+#include <cstring>
+
+const uint8_t* find_crlf(const uint8_t* begin, const uint8_t* end) {
+    if (end - begin < 2) {
+        return end;
+    }
+    const uint8_t* last = end - 1; // the '\r' has to be followed by a byte
+    const uint8_t* pos = begin;
+    while (pos < last) {
+        pos = static_cast<const uint8_t*>(memchr(pos, '\r', last - pos));
+        if (pos == nullptr) {
+            return end;
+        }
+        if (pos[1] == '\n') {
+            return pos;
+        }
+        pos++;
+    }
+    return end;
+}
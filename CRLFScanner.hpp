@@ -0,0 +1,28 @@
+/**
+ * @file CRLFScanner.hpp
+ * @brief CRLF delimiter scanner header
+ * 
+ * Search for the "\r\n" message delimiter of the TCP byte stream. The '\r' candidates are found by memchr,
+ * which the C library already vectorizes for the CPU it runs on.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef CRLFSCANNER_HPP
+#define CRLFSCANNER_HPP
+
+#include <stdint.h>
+
+/**
+ * @brief Find the first "\r\n" delimiter
+ * 
+ * Only delimiters lying completely inside the range are found, a '\r' as the last byte is not reported.
+ * 
+ * @param begin Start of the searched data
+ * @param end End of the searched data
+ * @return const uint8_t* Position of the '\r', end if there is no delimiter
+ */
+const uint8_t* find_crlf(const uint8_t* begin, const uint8_t* end);
+
+#endif // CRLFSCANNER_HPP
@@ -14,13 +14,17 @@ Client::Client(const string& protocol, const string& server, int port, int timeo
     this->waiting_on_reply = false;
     this->err_received = false;
     this->auth = false;
+    this->queue_peak = 0;
+    this->input_pauses = 0;
+    this->input_paused = false;
+    this->set_queue_capacity(CLIENT_QUEUE_CAPACITY);
 
     // socket
     this->socktype = strcmp(protocol.c_str(), "tcp") == 0 ? SOCK_STREAM : SOCK_DGRAM;
     this->sock = socket(AF_INET, this->socktype, 0);
     if (this->sock < 0) {
-        cerr << "ERR: Failed to create socket\n";
-        this->state = ClientState::ERROR_EXIT;
+        output.err << "ERR: Failed to create socket\n";
+        this->set_state(ClientState::ERROR_EXIT);
         return;
     }
 
@@ -41,12 +45,38 @@ Client::Client(const string& protocol, const string& server, int port, int timeo
         // resolve the domain name
         int status = getaddrinfo(server.c_str(), to_string(port).c_str(), &hints, &res);
         if (status != 0) {
-            cerr << "ERR: getaddrinfo: " << gai_strerror(status) << std::endl;
-            this->state = ClientState::ERROR_EXIT;
+            output.err << "ERR: getaddrinfo: " << gai_strerror(status) << "\n";
+            this->set_state(ClientState::ERROR_EXIT);
             return;
         }
         memcpy(&this->server_addr, res->ai_addr, sizeof(this->server_addr));
         freeaddrinfo(res); 
     }
-    //cout << "INFO: Server socket: " << inet_ntoa(this->server_addr.sin_addr) << " : " << ntohs(this->server_addr.sin_port) << "\n"; // DEBUG
+    TRACE(SERVER_ADDRESS, 0, static_cast<uint8_t>(this->state), ntohs(this->server_addr.sin_port));
+}
+
+void Client::set_queue_capacity(long capacity) {
+    this->queue_capacity = clamp(capacity, 1L, long(CLIENT_QUEUE_MAX));
+    this->queue_low_water = this->queue_capacity / 2;
+    // a message takes ~1.4 KB, only the first ones are preallocated, a deeper queue grows by doubling
+    this->client_msg_queue.reserve(min(this->queue_capacity + 1, size_t(CLIENT_QUEUE_PREALLOC)));
+}
+
+bool Client::accepts_input() {
+    size_t depth = this->client_msg_queue.size();
+    if (this->input_paused && depth <= this->queue_low_water) {
+        this->input_paused = false;
+    }
+    else if (!this->input_paused && depth >= this->queue_capacity) {
+        this->input_paused = true;
+        this->input_pauses++;
+    }
+    return !this->input_paused;
+}
+
+void Client::print_stats(OutputSink::Stream& out) const {
+    out << "STATS client_queue depth=" << this->client_msg_queue.size() << " peak=" << this->queue_peak 
+        << " capacity=" << this->queue_capacity << " input_pauses=" << this->input_pauses << "\n";
+    this->reply_latency.print(out, "reply");
+    this->queue_latency.print(out, "client_queue");
 }
@@ -3,7 +3,8 @@
  * @brief Client class header
  * 
  * A parent class for TCPClient and UDPClient classes, contains common attributes and methods for both classes.
- * Contains ClientState enum, which is used for implementation of Client FSM.
+ * Uses the ClientState enum (ClientState.hpp) for the implementation of the Client FSM, and contains the
+ * ClientEngine template with the logic shared by both transports.
  * 
  * @author Adam Valík <xvalik05@vutbr.cz>
  * 
@@ -12,7 +13,14 @@
 #ifndef CLIENT_HPP
 #define CLIENT_HPP
 
+#include "ClientState.hpp"
 #include "Message.hpp"
+#include "MessageArena.hpp"
+#include "RingQueue.hpp"
+#include "OutputSink.hpp"
+#include "LatencyHistogram.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
 
 #include <iostream>
 #include <cstring>
@@ -23,6 +31,7 @@
 #include <errno.h>
 #include <vector>
 #include <queue>
+#include <chrono>
 
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -33,20 +42,22 @@
 #include <netdb.h> 
 
 #define BUFFER_SIZE 1500
+#define CLIENT_QUEUE_CAPACITY 1024 // default capacity of the client message queue (messages)
+#define CLIENT_QUEUE_MAX 65536 // largest accepted capacity (-q)
+#define CLIENT_QUEUE_PREALLOC 64 // messages preallocated in the queue, it grows beyond them when needed
 
 // not having to write std:: everywhere
 using namespace std;
 
+static_assert(sizeof(CLIENT_STATE_NAMES) / sizeof(CLIENT_STATE_NAMES[0]) == METRICS_STATES);
+
+
 /**
- * @brief States of the client FSM
+ * @brief A message waiting in the client message queue
  */
-enum ClientState {
-    START,
-    AUTHENTICATE,
-    OPEN,
-    END,
-    ERROR,
-    ERROR_EXIT
+struct QueuedMsg {
+    Message msg;
+    chrono::steady_clock::time_point queued_at; // when the user input was read
 };
 
 
@@ -54,8 +65,8 @@ enum ClientState {
  * @class Client
  * @brief A parent class for TCPClient and UDPClient classes
  * 
- * Contains common attributes and methods for both classes. Used in main.cpp as a general client
- * regradless of the chosen transport protocol. Virtual methods are then implemented in TCPClient and UDPClient.
+ * Contains common attributes and methods for both classes. The transport specific methods are implemented
+ * in TCPClient and UDPClient, which are used through the ClientEngine template, so there are no virtual calls.
  * 
  */
 class Client {
@@ -71,11 +82,18 @@ class Client {
         int socktype; // SOCK_STREAM or SOCK_DGRAM
         
         struct sockaddr_in server_addr;
-        char buffer[BUFFER_SIZE];
 
         // queues for incoming and outgoing messages
-        queue<shared_ptr<Message>> client_msg_queue;
-        queue<vector<uint8_t>> server_msg_queue;
+        RingQueue<QueuedMsg> client_msg_queue; // messages are stored inline, by value
+        MessageArena server_msg_queue; // incoming messages are stored in place, without allocation
+
+        // client message queue bound, the input is paused at the capacity (high-water mark) until the queue
+        // drains to the low-water mark
+        size_t queue_capacity;
+        size_t queue_low_water;
+        size_t queue_peak; // the deepest the queue has been
+        size_t input_pauses; // how many times the input was paused
+        bool input_paused;
 
         bool waiting_on_reply; // flag for waiting on server reply to auth/join message
         bool err_received; // flag indicating that ERR message was received from the server
@@ -83,6 +101,25 @@ class Client {
 
         string error_msg; 
 
+        // latencies: AUTH/JOIN sent -> REPLY, user input read -> message sent
+        LatencyHistogram reply_latency;
+        LatencyHistogram queue_latency;
+        chrono::steady_clock::time_point reply_wait_start; // when the message awaiting the reply was sent
+
+        Metrics metrics; // counters of the session, exported by the MetricsServer
+
+        /**
+         * @brief Stop waiting on the reply, once the reply to the message at the front of the queue is handled
+         * 
+         * @param ok Result of the reply
+         */
+        void reply_received(bool ok) {
+            Metrics::add(ok ? this->metrics.replies_ok : this->metrics.replies_nok);
+            this->reply_latency.record(chrono::steady_clock::now() - this->reply_wait_start);
+            this->client_msg_queue.pop(); // remove the message being replied to from the client_queue
+            this->waiting_on_reply = false; // allow sending another message
+        }
+
     public:
         /**
          * @brief Construct a new Client object
@@ -98,36 +135,161 @@ class Client {
          * @param max_retransmissions Maximum number of retransmissions for UDP messages (after initial transmission)
          */
         Client(const string& transp, const string& server, int port, int timeout, int max_retransmissions);
-        virtual void send_msg(shared_ptr<Message>) {};
-        virtual void receive_msg() {};
-        virtual void process_client_messages() {};
-        virtual void process_server_messages() {};
-        virtual ~Client() {};
 
         // getters and setters
         ClientState get_state() const { return this->state; }
         int get_sock() const { return this->sock; }
-        int get_curr_msgID() { return this->client_msg_queue.front()->get_msgID(); }
-        shared_ptr<Message> get_curr_msg() { return this->client_msg_queue.front(); }
+        size_t get_queue_depth() const { return this->client_msg_queue.size(); }
+        int get_curr_msgID() { return get_msgID(this->client_msg_queue.front().msg); }
+        const Message& get_curr_msg() { return this->client_msg_queue.front().msg; }
         bool get_err_received() { return this->err_received; }
         string get_error_msg() { return this->error_msg; }
         bool is_auth() { return this->auth; }
         void set_err_msg(const string& msg) { this->error_msg = msg; }
-        void set_state(ClientState state) { this->state = state; }
+        void set_state(ClientState state) {
+            if (state != this->state) {
+                Metrics::add(this->metrics.state_transitions[state]);
+            }
+            this->state = state;
+        }
+
+        /**
+         * @brief Refresh the gauges and get the metrics of the session
+         * 
+         * @return const Metrics& Counters and gauges, to be serialized right away
+         */
+        const Metrics& snapshot_metrics() {
+            Metrics::set(this->metrics.client_queue_depth, this->client_msg_queue.size());
+            Metrics::set(this->metrics.server_queue_depth, this->server_msg_queue.size());
+            return this->metrics;
+        }
 
         /**
          * @brief Push a message to the client message queue
          * 
-         * @param msg Message in a form of a shared pointer
+         * @param msg Message, copied into the queue
+         */
+        void push_client_msg(const Message& msg) {
+            this->client_msg_queue.push({msg, chrono::steady_clock::now()});
+            this->queue_peak = max(this->queue_peak, this->client_msg_queue.size());
+        }
+
+        /**
+         * @brief Set the capacity of the client message queue
+         * 
+         * @param capacity Queue depth at which the input is paused, it is resumed at half of it
+         * (limited to between 1 and CLIENT_QUEUE_MAX)
+         */
+        void set_queue_capacity(long capacity);
+
+        /**
+         * @brief Check whether more user input should be read (pull-based backpressure)
+         * 
+         * Turns false once the client message queue reaches its capacity and true again once it drains 
+         * to the low-water mark, so the input is not toggled on every message.
+         * 
+         * @return true The queue has room for more messages
          */
-        void push_client_msg(shared_ptr<Message> msg) { this->client_msg_queue.push(msg); }
+        bool accepts_input();
 
         /**
-         * @brief Push a message to the server message queue
+         * @brief Print the client statistics, one group per line
          * 
-         * @param msg Message in a form of a vector of bytes
+         * @param out Output stream of the sink
          */
-        void push_server_msg(vector<uint8_t> msg) { this->server_msg_queue.push(msg); }
+        void print_stats(OutputSink::Stream& out) const;
 };
 
+
+/**
+ * @class ClientEngine
+ * @brief Logic shared by TCPClient and UDPClient, bound to the transport at compile time (CRTP)
+ * 
+ * The transport class derives from ClientEngine<itself> and implements send_msg(), receive_msg() and 
+ * process_server_messages(). The remaining hooks have default implementations here, which the transport 
+ * may hide by its own. Calls through transport() are resolved statically, so they can be inlined.
+ * 
+ */
+template <typename Transport>
+class ClientEngine : public Client {
+    protected:
+        Transport& transport() { return static_cast<Transport&>(*this); }
+
+        /**
+         * @brief Check if the message can be sent now, the transport may hold it back (e.g. full send window)
+         */
+        bool window_allows(const Message&) { return true; }
+
+    public:
+        using Client::Client;
+
+        int next_timeout() { return -1; } // poll() timeout in milliseconds, -1 for no timer
+        void process_timeouts() {}
+        void flush() {} // wait until the sent messages are delivered
+        void flush_sends() {} // write out the messages sent by the last batch, if the transport buffers them
+        bool wants_write() const { return false; } // some output waits for the socket to become writable
+
+        /**
+         * @brief Process messages from the client stored in the queue
+         * 
+         * Sends the messages from the queue to the server if the client is not waiting for a response
+         * and the transport allows it. The messages sent by one call are written out together at the end.
+         * 
+         */
+        void process_client_messages();
+};
+
+
+template <typename Transport>
+void ClientEngine<Transport>::process_client_messages() {
+    // send messages only when not waiting on a reply
+    while (!this->waiting_on_reply && !this->client_msg_queue.empty()) {
+        TRACE(PROCESS_CLIENT, 0, static_cast<uint8_t>(this->state));
+
+        const Message& msg = this->client_msg_queue.front().msg;
+        MessageType type = get_type(msg);
+
+        if (type != MessageType::AUTH && !this->auth) {
+            output.err << "ERR: You need to authenticate first\n";
+            this->client_msg_queue.pop();
+            continue;
+        }
+        if ((type == MessageType::MSG || type == MessageType::JOIN) && this->state != ClientState::OPEN) {
+            output.err << "ERR: Cannot send message in non-open state\n";
+            this->client_msg_queue.pop();
+            continue;
+        }
+        if (type == MessageType::AUTH && this->auth) { 
+            output.err << "ERR: No need to authenticate, already authenticated\n"; 
+            this->client_msg_queue.pop();
+            continue;
+        }
+        if (!this->transport().window_allows(msg)) {
+            // write out the batch so far to make room, otherwise wait for the transport 
+            // (confirmations of the messages in flight, or the socket to become writable)
+            this->transport().flush_sends();
+            if (!this->transport().window_allows(msg)) {
+                break;
+            }
+        }
+
+        // send the message, it is encoded before it can leave the queue
+        auto now = chrono::steady_clock::now();
+        this->queue_latency.record(now - this->client_msg_queue.front().queued_at);
+        this->transport().send_msg(msg);
+        TRACE(MSG_SENT, get_msgID(msg), static_cast<uint8_t>(this->state), type);
+
+        if (type == MessageType::AUTH || type == MessageType::JOIN) {
+            this->reply_wait_start = now;
+            // the reply may arrive before the confirmation, so be ready for it already
+            TRACE(WAIT_REPLY, get_msgID(msg), static_cast<uint8_t>(this->state));
+            this->waiting_on_reply = true;
+        }
+        else {
+            this->client_msg_queue.pop();
+        }
+    }
+    this->transport().flush_sends();
+}
+
 #endif // CLIENT_HPP
@@ -0,0 +1,33 @@
+/**
+ * @file ClientState.hpp
+ * @brief States of the client FSM
+ * 
+ * Kept apart from the Client class, so the tools decoding the client's records (tools/trace_decode.cpp)
+ * share the names with the client.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef CLIENTSTATE_HPP
+#define CLIENTSTATE_HPP
+
+/**
+ * @brief States of the client FSM
+ */
+enum ClientState {
+    START,
+    AUTHENTICATE,
+    OPEN,
+    END,
+    ERROR,
+    ERROR_EXIT
+};
+
+/**
+ * @brief Names of the ClientState values, indexed by the state
+ */
+inline constexpr const char* CLIENT_STATE_NAMES[] = { "START", "AUTHENTICATE", "OPEN", "END", "ERROR", "ERROR_EXIT" };
+static_assert(sizeof(CLIENT_STATE_NAMES) / sizeof(CLIENT_STATE_NAMES[0]) == ERROR_EXIT + 1, "a name for every state");
+
+#endif // CLIENTSTATE_HPP
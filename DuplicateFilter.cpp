@@ -0,0 +1,40 @@
+/**
+ * @file DuplicateFilter.cpp
+ * @brief DuplicateFilter class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "DuplicateFilter.hpp"
+
+#include <algorithm>
+
+
+void DuplicateFilter::clear_range(uint16_t start, uint32_t count) {
+    uint32_t pos = start;
+    while (count > 0) {
+        uint32_t bit = pos & 63;
+        uint32_t n = min<uint32_t>(64 - bit, count); // bits to clear in this word
+        uint64_t mask = (n == 64) ? ~0ULL : (((1ULL << n) - 1) << bit);
+        this->bits[(pos >> 6) % this->bits.size()] &= ~mask;
+        pos = (pos + n) % ID_SPACE;
+        count -= n;
+    }
+}
+
+
+void DuplicateFilter::mark(uint16_t msgID) {
+    if (this->empty) {
+        this->newest = msgID;
+        this->empty = false;
+    }
+
+    uint16_t distance = msgID - this->newest;
+    if (distance != 0 && distance < WINDOW) {
+        // newer ID, the IDs that are now more than WINDOW behind leave the window
+        this->clear_range(static_cast<uint16_t>(this->newest - WINDOW + 1), distance);
+        this->newest = msgID;
+    }
+    this->bits[msgID >> 6] |= 1ULL << (msgID & 63);
+}
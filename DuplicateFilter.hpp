@@ -0,0 +1,61 @@
+/**
+ * @file DuplicateFilter.hpp
+ * @brief DuplicateFilter class header
+ * 
+ * Detection of duplicated UDP messages by their message ID, with a fixed size bitmap.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef DUPLICATEFILTER_HPP
+#define DUPLICATEFILTER_HPP
+
+#include <stdint.h>
+#include <array>
+
+using namespace std;
+
+/**
+ * @class DuplicateFilter
+ * @brief A sliding window of seen message IDs over a flat 65536 bit table
+ * 
+ * The window holds the 32768 IDs up to the newest seen ID (in the serial number arithmetic, RFC1982).
+ * When the newest ID moves forward, the IDs leaving the window are cleared, so once the 16-bit messageID 
+ * wraps around, the reused IDs are not reported as duplicates. Checks are O(1) and never allocate.
+ * 
+ */
+class DuplicateFilter {
+    static constexpr uint32_t ID_SPACE = 65536;
+    static constexpr uint32_t WINDOW = ID_SPACE / 2;
+
+    array<uint64_t, ID_SPACE / 64> bits;
+    uint16_t newest; // the most recent ID in the window
+    bool empty; // no ID was seen yet
+
+    /**
+     * @brief Clear count bits starting at the ID start, wrapping around the ID space
+     */
+    void clear_range(uint16_t start, uint32_t count);
+
+    public:
+        DuplicateFilter() : bits{}, newest(0), empty(true) {};
+
+        /**
+         * @brief Check if the message ID has been seen before
+         * 
+         * @param msgID Message ID to check
+         * @return true The message ID has been seen before
+         * @return false The message ID has not been seen before
+         */
+        bool seen(uint16_t msgID) const { return (this->bits[msgID >> 6] >> (msgID & 63)) & 1; }
+
+        /**
+         * @brief Mark the message ID as seen, moving the window forward if the ID is newer
+         * 
+         * @param msgID Message ID to mark as seen
+         */
+        void mark(uint16_t msgID);
+};
+
+#endif // DUPLICATEFILTER_HPP
@@ -0,0 +1,186 @@
+/**
+ * @file EventLoop.hpp
+ * @brief Main loop of the client application
+ * 
+ * The loop is a template instantiated for the chosen client class, so all calls to the client 
+ * are resolved at compile time.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef EVENTLOOP_HPP
+#define EVENTLOOP_HPP
+
+#include "Client.hpp"
+#include "InputHandler.hpp"
+#include "InputReader.hpp"
+#include "Message.hpp"
+#include "MetricsServer.hpp"
+
+#include <atomic>
+#include <string_view>
+
+using namespace std;
+
+/**
+ * @brief Process user input and incoming messages until the communication ends
+ * 
+ * Polls stdin and the client socket, passes the user input to the client through the input handler
+ * and lets the client process its queues. When exiting, sends the ERR/BYE message if needed.
+ * 
+ * @param client TCPClient or UDPClient
+ * @param input_handler Parser of the user input
+ * @param interrupt Flag set by the signal handler
+ * @param dump_stats Flag set by the signal handler when the statistics are requested, cleared once printed
+ * @param print_stats Print the client statistics to stderr on exit
+ * @param metrics Server of the metrics snapshots, its sockets are polled along with the client
+ * @return int EXIT_FAILURE if there was an error on either the client or server side, otherwise EXIT_SUCCESS
+ */
+template <typename Transport>
+int run_client(Transport& client, InputHandler& input_handler, const atomic<bool>& interrupt, atomic<bool>& dump_stats, bool print_stats, MetricsServer& metrics) {
+    InputReader input(STDIN_FILENO); // user input, split into lines in bulk
+    bool stdin_open = true;
+    bool quit = false; // /exit before authentication
+
+    // setup poll: stdin, socket and the metrics scrapers
+    struct pollfd fds[2 + 1 + METRICS_MAX_CONNECTIONS];
+    fds[0].fd = STDIN_FILENO; 
+    fds[0].events = POLLIN;
+    fds[1].fd = client.get_sock();        
+    fds[1].events = POLLIN;
+
+    // main loop - process incoming messages and user input until:
+    while ( client.get_state() != ClientState::ERROR_EXIT  // ERR before connection 
+            && client.get_state() != ClientState::ERROR    // ERR from client
+            && !client.get_err_received()                  // ERR from server
+            && !interrupt.load()                           // signal interrupt
+            && client.get_state() != ClientState::END )    // BYE received
+    {                                               
+
+        // print the statistics when requested (SIGUSR1), without interrupting the session
+        if (dump_stats.exchange(false)) {
+            client.print_stats(output.err);
+        }
+
+        // write out the output of the previous iteration before waiting
+        output.flush();
+
+        // stop reading stdin while the client message queue is full, a negative fd is ignored by poll
+        // (the unread input waits in the pipe, so a fast writer is blocked instead of the memory growing),
+        // stdin is not waited for either while there are complete lines left in the input buffer
+        bool input_ready = false;
+        if (stdin_open) {
+            bool accepts_input = client.accepts_input();
+            input_ready = accepts_input && input.has_line();
+            fds[0].fd = accepts_input && !input_ready ? STDIN_FILENO : -1;
+        }
+
+        // wait for stdin/socket input, or until the earliest retransmission is due
+        // (also for the socket to become writable when some output could not be written yet)
+        fds[1].events = POLLIN | (client.wants_write() ? POLLOUT : 0);
+        int timeout = input_ready ? 0 : client.next_timeout();
+        TRACE(POLL_WAIT, 0, static_cast<uint8_t>(client.get_state()), static_cast<uint16_t>(timeout));
+        size_t nfds = 2 + metrics.poll_fds(fds + 2);
+        int ret = poll(fds, nfds, timeout);
+    
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue; // interrupted by signal, check quit flag
+            }
+            client.set_err_msg("poll()");
+            output.err << "ERR: poll\n";
+            client.set_state(ClientState::ERROR);
+            break;
+        }
+
+        // answer the metrics scrapes, non-blocking
+        metrics.handle(fds + 2, nfds - 2, [&client]() -> const Metrics& { return client.snapshot_metrics(); });
+
+        // read the next chunk of input (POLLHUP without POLLIN is reported for a closed pipe)
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            input.fill();
+        }
+
+        // handle the buffered input lines, as many as fit into the client message queue
+        string_view line;
+        while (stdin_open && client.accepts_input() && input.next_line(line)) {
+            // exit command in the start state - just exit, no bye msg
+            if (line == "/exit" && client.get_state() == ClientState::START) {
+                quit = true;
+                break;
+            }
+
+            auto msg = input_handler.handle_input(line);
+            if (msg) {
+                TRACE(INPUT_PUSH, get_msgID(*msg), static_cast<uint8_t>(client.get_state()), static_cast<uint16_t>(min(client.get_queue_depth(), size_t(0xFFFF))));
+                client.push_client_msg(*msg);
+            }
+        }
+        if (quit) {
+            break;
+        }
+
+        // eof was encountered and all the lines were handled
+        if (stdin_open && input.at_end()) {
+            stdin_open = false;
+            fds[0].fd = -1; // remove stdin from poll set
+            auto msg = input_handler.handle_input("/exit"); // prepare BYE message
+            client.push_client_msg(*msg);
+        }
+
+        if (fds[1].revents & POLLIN) {
+            // handle incoming message
+            TRACE(SOCKET_READABLE, 0, static_cast<uint8_t>(client.get_state()));
+            client.receive_msg();
+        }
+
+        if (fds[1].revents & POLLOUT) {
+            // resume the partially written output
+            client.flush_sends();
+        }
+
+        // retransmit messages whose confirmation timed out
+        client.process_timeouts();
+
+
+        // process stdin inputs and incoming messages from queues
+        client.process_client_messages();
+        client.process_server_messages();
+    }
+
+    output.flush();
+
+    // send ERR message if there was an error during the client-server communication
+    if (client.get_state() == ClientState::ERROR) {
+        TRACE(SEND_ERR, input_handler.get_msgID_sent(), static_cast<uint8_t>(client.get_state()));
+        client.send_msg(MsgERR{input_handler.get_msgID_sent(), input_handler.get_display_name(), client.get_error_msg()});
+        client.flush();
+        input_handler.inc_msgID_sent();
+    }
+
+    // send BYE message if there was an error on the client side, error received from the server or signal interrupt (bye for end/eof was already sent)
+    if (client.get_state() == ClientState::ERROR || client.get_err_received() || (interrupt.load() && client.get_state() != ClientState::START) ){
+        TRACE(SEND_BYE, input_handler.get_msgID_sent(), static_cast<uint8_t>(client.get_state()));
+        client.send_msg(MsgBYE{input_handler.get_msgID_sent()});
+        client.flush();
+    }
+
+    // deliver the output that is still buffered (e.g. the BYE sent on eof)
+    if (client.wants_write()) {
+        client.flush();
+    }
+
+    if (print_stats) {
+        client.print_stats(output.err);
+    }
+
+    output.flush();
+
+    // EXIT_FAILURE if there was an error on either the client or server side, otherwise EXIT_SUCCESS
+    int exit_code = (client.get_state() == ClientState::ERROR || client.get_state() == ClientState::ERROR_EXIT || client.get_err_received()) ? EXIT_FAILURE : EXIT_SUCCESS;
+    TRACE(EXIT, 0, static_cast<uint8_t>(client.get_state()), exit_code);
+    return exit_code;
+}
+
+#endif // EVENTLOOP_HPP
@@ -12,13 +12,17 @@
 #define INPUTHANDLER_HPP
 
 #include "Message.hpp"
+#include "Validators.hpp"
+#include "OutputSink.hpp"
+#include "Trace.hpp"
 
 #include <stdint.h>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <iostream>
-#include <regex>
+#include <optional>
 
 using namespace std;
 
@@ -32,7 +36,7 @@ class InputHandler {
         ~InputHandler() {};
 
         // getters
-        int get_msgID_sent() { return this->msgID_sent; } // for sending messages not through the input handler (BYE/ERR)
+        uint16_t get_msgID_sent() { return this->msgID_sent; } // for sending messages not through the input handler (BYE/ERR)
         string get_display_name() { return this->display_name; }
         
         /**
@@ -43,12 +47,12 @@ class InputHandler {
         /**
          * @brief Parse the user input and create a message based on the input
          * 
-         * Also checks the input for validity using regex patterns
+         * Also checks the input for validity using the validators of the grammar rules
          * 
-         * @param input User input from stdin
-         * @return shared_ptr<Message> A message created based on the input
+         * @param input A line of the user input from stdin
+         * @return optional<Message> A message created based on the input, nullopt when there is nothing to send
          */
-        shared_ptr<Message> handle_input(string& input);
+        optional<Message> handle_input(string_view input);
 };
 
 #endif // CLIENTMSGHANDLER_HPP
\ No newline at end of file
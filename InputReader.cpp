@@ -0,0 +1,130 @@
+/**
+ * @file InputReader.cpp
+ * @brief InputReader class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "InputReader.hpp"
+#include "OutputSink.hpp"
+
+#include <cstring>
+#include <algorithm>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+InputReader::InputReader(int fd) : fd(fd), map(nullptr), map_size(0), head(0), tail(0), scanned(0), eof(false), discarding(false) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        // the input may have already been partially read by someone else, start from the current offset
+        off_t offset = lseek(fd, 0, SEEK_CUR);
+        if (offset >= 0 && st.st_size > offset) {
+            void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                madvise(addr, st.st_size, MADV_SEQUENTIAL);
+                this->map = static_cast<const char*>(addr);
+                this->map_size = st.st_size;
+                this->head = this->scanned = offset;
+                this->tail = st.st_size;
+                this->eof = true; // all of the input is available
+                return;
+            }
+        }
+    }
+    // fall back to read()
+    this->buf.resize(INPUT_CHUNK_SIZE);
+}
+
+InputReader::~InputReader() {
+    if (this->map != nullptr) {
+        munmap(const_cast<char*>(this->map), this->map_size);
+    }
+}
+
+
+ssize_t InputReader::fill() {
+    if (this->map != nullptr || this->eof) {
+        return 0;
+    }
+
+    // move the unconsumed bytes to the start when running out of space
+    if (this->head == this->tail) {
+        this->head = this->tail = this->scanned = 0;
+    }
+    else if (this->head > 0 && this->buf.size() - this->tail < INPUT_CHUNK_SIZE / 2) {
+        memmove(this->buf.data(), this->buf.data() + this->head, this->tail - this->head);
+        this->tail -= this->head;
+        this->scanned -= this->head;
+        this->head = 0;
+    }
+    if (this->tail == this->buf.size()) {
+        // no newline in the whole buffer
+        this->discard_line();
+        this->head = this->tail = this->scanned = 0;
+    }
+
+    ssize_t bytesrx = read(this->fd, this->buf.data() + this->tail, this->buf.size() - this->tail);
+    if (bytesrx > 0) {
+        this->tail += bytesrx;
+    }
+    else if (bytesrx == 0 || (errno != EINTR && errno != EAGAIN)) {
+        // end of file, an unreadable input is treated the same way
+        this->eof = true;
+    }
+    return bytesrx;
+}
+
+
+bool InputReader::has_line() {
+    if (this->eof && this->head < this->tail) {
+        return true;
+    }
+    const char* data = this->map != nullptr ? this->map : this->buf.data();
+    return memchr(data + this->scanned, '\n', this->tail - this->scanned) != nullptr;
+}
+
+void InputReader::discard_line() {
+    output.err << "ERR: Input line is too long\n";
+    this->head = this->scanned = this->tail;
+    this->discarding = true;
+}
+
+bool InputReader::next_line(string_view& line) {
+    const char* data = this->map != nullptr ? this->map : this->buf.data();
+
+    const char* newline = static_cast<const char*>(memchr(data + this->scanned, '\n', this->tail - this->scanned));
+    if (this->discarding) {
+        // the rest of the too long line, up to and including its newline
+        this->head = this->scanned = newline != nullptr ? newline - data + 1 : this->tail;
+        if (newline == nullptr) {
+            return false;
+        }
+        this->discarding = false;
+        newline = static_cast<const char*>(memchr(data + this->scanned, '\n', this->tail - this->scanned));
+    }
+
+    size_t end;
+    if (newline != nullptr) {
+        end = newline - data;
+    }
+    else if (this->eof && this->head < this->tail) {
+        end = this->tail; // the last line is not terminated
+    }
+    else {
+        if (this->tail - this->head > INPUT_LINE_MAX) {
+            // no valid line is this long, it is not buffered any further
+            this->discard_line();
+            return false;
+        }
+        // the bytes searched so far are not searched again after the next fill()
+        this->scanned = this->tail;
+        return false;
+    }
+
+    line = string_view(data + this->head, end - this->head);
+    this->head = this->scanned = min(end + 1, this->tail);
+    return true;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file InputReader.hpp
+ * @brief InputReader class header
+ * 
+ * A bulk reader of the user input, which splits the standard input into lines in place.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef INPUTREADER_HPP
+#define INPUTREADER_HPP
+
+#include <stdint.h>
+#include <vector>
+#include <string_view>
+#include <sys/types.h>
+
+#define INPUT_CHUNK_SIZE 65536 // bytes requested by one read(), also the size of the read buffer
+#define INPUT_LINE_MAX 4096 // longest line kept, the longest valid one (a 1400 character message) with slack
+
+using namespace std;
+
+/**
+ * @class InputReader
+ * @brief Reads the input in large chunks and hands out the lines as views, without copying them
+ * 
+ * A regular file is mapped into memory as a whole, anything else (pipe, terminal) is read by read()
+ * into a fixed buffer. A line longer than INPUT_LINE_MAX is reported as too long and skipped up to its
+ * newline, so the buffer never grows. Lines are split the way getline() does: the '\n' is removed and
+ * the last line does not have to be terminated.
+ * 
+ */
+class InputReader {
+    int fd;
+
+    // mapped regular file
+    const char* map;
+    size_t map_size;
+
+    // read buffer, holds bytes [head, tail)
+    vector<char> buf;
+    size_t head; // start of the first unconsumed line
+    size_t tail; // end of the read data
+    size_t scanned; // the newline search continues from here
+
+    bool eof; // no more data can be read
+    bool discarding; // the rest of a too long line is skipped
+
+    // report the buffered line as too long and skip it up to its newline
+    void discard_line();
+
+    public:
+        /**
+         * @brief Construct a new InputReader object
+         * 
+         * @param fd File descriptor of the input, a regular file is mapped at once
+         */
+        InputReader(int fd);
+        ~InputReader();
+
+        InputReader(const InputReader&) = delete;
+        InputReader& operator=(const InputReader&) = delete;
+
+        /**
+         * @brief Read the next chunk of the input (call when the descriptor is readable)
+         * 
+         * @return ssize_t Result of read(), 0 on end of file or for a mapped file
+         */
+        ssize_t fill();
+
+        /**
+         * @brief Get the next line and consume it
+         * 
+         * @param line The line without the '\n', valid until the next fill() call
+         * @return true A line was extracted
+         * @return false No complete line is buffered (the unterminated last line is returned once eof is reached)
+         */
+        bool next_line(string_view& line);
+
+        /**
+         * @return true A line can be extracted without reading (no need to wait for the descriptor)
+         */
+        bool has_line();
+
+        /**
+         * @return true The whole input was read and all of its lines were consumed
+         */
+        bool at_end() const { return this->eof && this->head == this->tail; }
+};
+
+#endif // INPUTREADER_HPP
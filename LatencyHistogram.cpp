@@ -0,0 +1,46 @@
+/**
+ * @file LatencyHistogram.cpp
+ * @brief LatencyHistogram class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "LatencyHistogram.hpp"
+
+#include <cmath>
+
+uint64_t LatencyHistogram::value_of(size_t bucket) {
+    if (bucket < SUB_COUNT) {
+        return bucket;
+    }
+    unsigned shift = bucket / SUB_COUNT - 1;
+    uint64_t lowest = (SUB_COUNT + bucket % SUB_COUNT) << shift;
+    return lowest + ((uint64_t(1) << shift) >> 1);
+}
+
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    if (this->total == 0) {
+        return 0;
+    }
+    // rank of the value, at least the first one
+    uint64_t rank = static_cast<uint64_t>(ceil(fraction * this->total));
+    rank = rank > 0 ? rank : 1;
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += this->counts[bucket];
+        if (seen >= rank) {
+            // the bucket middle may lie above the largest recorded value
+            return std::min(value_of(bucket), this->max_value);
+        }
+    }
+    return this->max_value;
+}
+
+
+void LatencyHistogram::print(OutputSink::Stream& out, string_view name) const {
+    out << "STATS latency " << name << " count=" << this->total << " p50_ns=" << this->percentile(0.5)
+        << " p99_ns=" << this->percentile(0.99) << " p999_ns=" << this->percentile(0.999) << " max_ns=" << this->max_value << "\n";
+}
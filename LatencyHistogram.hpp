@@ -0,0 +1,90 @@
+/**
+ * @file LatencyHistogram.hpp
+ * @brief LatencyHistogram class header
+ * 
+ * A log-linear histogram of latencies (HDR histogram style), with a fixed memory footprint.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include "OutputSink.hpp"
+
+#include <stdint.h>
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <string_view>
+
+using namespace std;
+
+/**
+ * @class LatencyHistogram
+ * @brief Counts of latencies in nanoseconds, in buckets whose width grows with the value
+ * 
+ * Each power of two range [2^k, 2^(k+1)) is split into 32 equal buckets, so any recorded value is known
+ * with a relative error below 3 %, from nanoseconds up to years, in 1920 counters. Recording a value is
+ * a few instructions, the percentiles are computed only when printed.
+ * 
+ */
+class LatencyHistogram {
+    static constexpr unsigned SUB_BITS = 5;
+    static constexpr uint64_t SUB_COUNT = 1 << SUB_BITS; // buckets per power of two
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    array<uint64_t, BUCKETS> counts;
+    uint64_t total;
+    uint64_t max_value;
+
+    // values below SUB_COUNT have their own buckets, the others are indexed by the top SUB_BITS + 1 bits
+    static size_t bucket_of(uint64_t value) {
+        if (value < SUB_COUNT) {
+            return value;
+        }
+        unsigned shift = bit_width(value) - 1 - SUB_BITS;
+        return (shift + 1) * SUB_COUNT + ((value >> shift) - SUB_COUNT);
+    }
+
+    // middle of the range of values counted by the bucket
+    static uint64_t value_of(size_t bucket);
+
+    public:
+        LatencyHistogram() : counts{}, total(0), max_value(0) {};
+
+        /**
+         * @brief Count one latency
+         * 
+         * @param latency Measured time
+         */
+        void record(chrono::steady_clock::duration latency) {
+            uint64_t ns = latency.count() > 0 ? chrono::duration_cast<chrono::nanoseconds>(latency).count() : 0;
+            this->counts[bucket_of(ns)]++;
+            this->total++;
+            this->max_value = std::max(this->max_value, ns);
+        }
+
+        /**
+         * @brief Get the latency that the given fraction of the recorded latencies does not exceed
+         * 
+         * @param fraction e.g. 0.99 for the 99th percentile
+         * @return uint64_t Latency in nanoseconds, 0 if nothing was recorded
+         */
+        uint64_t percentile(double fraction) const;
+
+        uint64_t count() const { return this->total; }
+        uint64_t max() const { return this->max_value; }
+
+        /**
+         * @brief Print the count, p50, p99, p999 and max on one line
+         * 
+         * @param out Output stream of the sink
+         * @param name Name of the measured latency
+         */
+        void print(OutputSink::Stream& out, string_view name) const;
+};
+
+#endif // LATENCYHISTOGRAM_HPP
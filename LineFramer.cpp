@@ -0,0 +1,85 @@
+/**
+ * @file LineFramer.cpp
+ * @brief LineFramer class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "LineFramer.hpp"
+#include "CRLFScanner.hpp"
+
+#include <algorithm>
+#include <errno.h>
+
+LineFramer::LineFramer() : ring(RECV_RING_SIZE), mask(RECV_RING_SIZE - 1), head(0), tail(0), scanned(0), scratch(RECV_RING_SIZE) {}
+
+
+ssize_t LineFramer::fill(int sock) {
+    size_t free_space = this->ring.size() - (this->tail - this->head);
+    if (free_space == 0) {
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    // the free space may wrap around the end of the ring
+    size_t pos = this->tail & this->mask;
+    size_t first = min(free_space, this->ring.size() - pos);
+    struct iovec iov[2] = {
+        { .iov_base = this->ring.data() + pos, .iov_len = first },
+        { .iov_base = this->ring.data(), .iov_len = free_space - first }
+    };
+
+    ssize_t bytesrx = readv(sock, iov, iov[1].iov_len > 0 ? 2 : 1);
+    if (bytesrx > 0) {
+        this->tail += bytesrx;
+    }
+    return bytesrx;
+}
+
+
+bool LineFramer::next_line(string_view& line) {
+    // at least two bytes are needed for the delimiter
+    while (this->scanned + 1 < this->tail) {
+        size_t pos = this->scanned & this->mask;
+        size_t contiguous = min(this->tail - this->scanned, this->ring.size() - pos);
+        const uint8_t* start = this->ring.data() + pos;
+
+        size_t cr_at;
+        const uint8_t* cr = find_crlf(start, start + contiguous);
+        if (cr != start + contiguous) {
+            cr_at = this->scanned + (cr - start);
+        }
+        else if (contiguous < this->tail - this->scanned) {
+            // the searched part ends at the end of the ring, the delimiter may be split by it
+            size_t last = this->scanned + contiguous - 1;
+            this->scanned += contiguous;
+            if (this->ring[last & this->mask] != '\r' || this->ring[this->scanned & this->mask] != '\n') {
+                continue;
+            }
+            cr_at = last;
+        }
+        else {
+            // the last byte may be a '\r' whose '\n' has not been received yet
+            this->scanned = this->tail - 1;
+            return false;
+        }
+
+        // complete line [head, cr_at)
+        size_t start_pos = this->head & this->mask;
+        size_t len = cr_at - this->head;
+        if (start_pos + len <= this->ring.size()) {
+            line = string_view(reinterpret_cast<const char*>(this->ring.data() + start_pos), len);
+        }
+        else {
+            // the line wraps around the end of the ring
+            size_t first = this->ring.size() - start_pos;
+            memcpy(this->scratch.data(), this->ring.data() + start_pos, first);
+            memcpy(this->scratch.data() + first, this->ring.data(), len - first);
+            line = string_view(reinterpret_cast<const char*>(this->scratch.data()), len);
+        }
+        this->head = this->scanned = cr_at + 2;
+        return true;
+    }
+    return false;
+}
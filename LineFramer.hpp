@@ -0,0 +1,69 @@
+/**
+ * @file LineFramer.hpp
+ * @brief LineFramer class header
+ * 
+ * A circular receive buffer for the TCP byte stream, which splits the stream into CRLF delimited lines.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef LINEFRAMER_HPP
+#define LINEFRAMER_HPP
+
+#include <stdint.h>
+#include <vector>
+#include <string_view>
+#include <cstring>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#define RECV_RING_SIZE 65536 // must be a power of two
+
+using namespace std;
+
+/**
+ * @class LineFramer
+ * @brief A per-connection circular receive buffer splitting the stream into lines
+ * 
+ * Data are read straight into the free part of the ring, the delimiter is searched for incrementally,
+ * so the bytes that were already searched are never scanned again. Lines are handed out as views into the ring.
+ * 
+ */
+class LineFramer {
+    vector<uint8_t> ring;
+    size_t mask;
+    // positions in the stream (not wrapped), the ring holds bytes [head, tail)
+    size_t head; // start of the first unconsumed line
+    size_t tail; // end of the received data
+    size_t scanned; // delimiter search continues from here
+    vector<uint8_t> scratch; // a line wrapping around the end of the ring is linearized here
+
+    public:
+        LineFramer();
+
+        /**
+         * @brief Receive data from the socket into the free part of the ring
+         * 
+         * @param sock Socket to read from
+         * @return ssize_t Result of readv(), or -1 with errno set to ENOBUFS when the ring is full
+         */
+        ssize_t fill(int sock);
+
+        /**
+         * @brief Get the next complete line and consume it
+         * 
+         * @param line The line without the delimiter, valid until the next fill() call
+         * @return true A line was extracted
+         * @return false No complete line is buffered
+         */
+        bool next_line(string_view& line);
+
+        /**
+         * @return true No space left in the ring, while no complete line is buffered
+         */
+        bool full() const { return this->tail - this->head == this->ring.size(); }
+};
+
+#endif // LINEFRAMER_HPP
@@ -1,10 +1,10 @@
 /**
  * @file Message.hpp
- * @brief Message class header
+ * @brief Message types header
  * 
- * A parent class for all message types, contains common attributes and methods for all message types.
- * This file also contains derived classes for each message type, which have their implementation of 
- * constructing TCP and UDP variant of the outgoing message.
+ * Each message type is a plain value type with its wire layout declared once as a WireSchema, from which 
+ * the TCP and UDP variants of the message are generated. Message is a variant of all the outgoing types, 
+ * dispatched statically with visit().
  * 
  * @author Adam Valík <xvalik05@vutbr.cz>
  * 
@@ -13,9 +13,17 @@
 #ifndef MESSAGE_HPP
 #define MESSAGE_HPP
 
+#include "WireSchema.hpp"
+
 #include <stdint.h>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <span>
+#include <cstring>
+#include <variant>
+#include <tuple>
+#include <algorithm>
 #include <arpa/inet.h>
 
 using namespace std;
@@ -34,117 +42,223 @@ enum MessageType: uint8_t {
 };
 
 /**
- * @class Message
- * @brief A parent class for all message types
+ * @class FixedString
+ * @brief A string stored inline with a fixed capacity, longer strings are truncated
+ */
+template <size_t N>
+class FixedString {
+    char chars[N];
+    uint16_t len;
+
+    public:
+        static constexpr size_t capacity = N;
+
+        FixedString() : len(0) {};
+        FixedString(string_view str) { this->assign(str); };
+        FixedString(const string& str) { this->assign(str); };
+
+        void assign(string_view str) {
+            this->len = min(str.size(), N);
+            memcpy(this->chars, str.data(), this->len);
+        }
+        string_view view() const { return string_view(this->chars, this->len); }
+        operator string_view() const { return this->view(); }
+};
+
+/**
+ * @brief A confirmation message
+ * 
+ *   1 byte       2 bytes      
+ * +--------+--------+--------+
+ * |  0x00  |  Ref_MessageID  |
+ * +--------+--------+--------+
+ */
+struct MsgCONFIRM {
+    using Schema = WireSchema<MessageType::CONFIRM, "">; // not used by TCP
+    static constexpr MessageType type = Schema::type;
+    uint16_t messageID;
+
+    auto fields() const { return tie(); }
+};
+
+/**
+ * @brief A reply to the AUTH or JOIN message, received from the server
  * 
- * Contains common attributes and methods for all message types. Each derived class has its own implementation
- * of constructing TCP and UDP variant of the outgoing message.
+ *   1 byte       2 bytes       1 byte       2 bytes      
+ * +--------+--------+--------+--------+--------+--------+--------~~---------+---+
+ * |  0x01  |    MessageID    | Result |  Ref_MessageID  |  MessageContents  | 0 |
+ * +--------+--------+--------+--------+--------+--------+--------~~---------+---+
  * 
+ * REPLY {"OK"|"NOK"} IS {MessageContent}\r\n
  */
-class Message {
-    protected:
-        MessageType type;
-        uint16_t messageID;
+struct MsgREPLY {
+    using Schema = WireSchema<MessageType::REPLY, "REPLY", Flag<" ", "OK", "NOK", "Unknown result", "Unknown reply type">, RefID, Content<" IS ", 1400>>;
+    static constexpr MessageType type = Schema::type;
+    uint16_t messageID;
+    bool result;
+    uint16_t ref_msgID;
+    FixedString<1400> message_content;
 
-    public:
-        Message(uint16_t messageID) : messageID(messageID) {};
-        virtual ~Message() {};
-
-        /**
-         * @brief Construct the UDP message header byte by byte
-         * 
-         * @return vector<uint8_t> UDP message to send
-         */
-        virtual vector<uint8_t> UDP_msg() { return {}; };
-
-        /**
-         * @brief Construct the TCP message based on the specified ABNF [RFC5234] grammar
-         * 
-         * @return string TCP message to send
-         */
-        virtual string TCP_msg() { return ""; };
-
-        // getters
-        uint16_t get_msgID() { return this->messageID; };
-        MessageType get_type() { return this->type; };
+    auto fields() const { return tie(this->result, this->ref_msgID, this->message_content); }
 };
 
 /**
- * @class MsgCONFIRM
- * @brief A derived class for a confirmation message
+ * @brief An authenticate message
+ * 
+ *   1 byte       2 bytes      
+ * +--------+--------+--------+-----~~-----+---+-------~~------+---+----~~----+---+
+ * |  0x02  |    MessageID    |  Username  | 0 |  DisplayName  | 0 |  Secret  | 0 |
+ * +--------+--------+--------+-----~~-----+---+-------~~------+---+----~~----+---+
+ * 
+ * AUTH {Username} AS {DisplayName} USING {Secret}\r\n
  */
-class MsgCONFIRM : public Message {
-    public:
-        MsgCONFIRM(uint16_t messageID) : Message(messageID) { this->type = MessageType::CONFIRM; };
-        vector<uint8_t> UDP_msg() override;
+struct MsgAUTH {
+    using Schema = WireSchema<MessageType::AUTH, "AUTH", Text<" ", 20>, Text<" AS ", 20>, Text<" USING ", 128>>;
+    static constexpr MessageType type = Schema::type;
+    uint16_t messageID;
+    FixedString<20> username;
+    FixedString<128> secret;
+    FixedString<20> display_name;
+
+    auto fields() const { return tie(this->username, this->display_name, this->secret); }
 };
 
 /**
- * @class MsgAUTH
- * @brief A derived class for an authenticate message
+ * @brief A join message
+ * 
+ *   1 byte       2 bytes      
+ * +--------+--------+--------+-----~~-----+---+-------~~------+---+
+ * |  0x03  |    MessageID    |  ChannelID | 0 |  DisplayName  | 0 |
+ * +--------+--------+--------+-----~~-----+---+-------~~------+---+
+ * 
+ * JOIN {ChannelID} AS {DisplayName}\r\n
  */
-class MsgAUTH : public Message {
-    string username; 
-    string secret;
-    string display_name;
+struct MsgJOIN {
+    using Schema = WireSchema<MessageType::JOIN, "JOIN", Text<" ", 20>, Text<" AS ", 20>>;
+    static constexpr MessageType type = Schema::type;
+    uint16_t messageID;
+    FixedString<20> channelID;
+    FixedString<20> display_name;
 
-    public:
-        MsgAUTH(string username, string secret, string display_name, uint16_t messageID) : Message(messageID), username(username), secret(secret), display_name(display_name) { this->type = MessageType::AUTH; }
-        vector<uint8_t> UDP_msg() override;
-        string TCP_msg() override;
+    auto fields() const { return tie(this->channelID, this->display_name); }
 };
 
 /**
- * @class MsgJOIN
- * @brief A derived class for a join message
+ * @brief A message to the server
+ * 
+ *   1 byte       2 bytes      
+ * +--------+--------+--------+-------~~------+---+--------~~---------+---+
+ * |  0x04  |    MessageID    |  DisplayName  | 0 |  MessageContents  | 0 |
+ * +--------+--------+--------+-------~~------+---+--------~~---------+---+
+ * 
+ * MSG FROM {DisplayName} IS {MessageContent}\r\n
  */
-class MsgJOIN : public Message {
-    string channelID;
-    string display_name;
+struct MsgMSG {
+    using Schema = WireSchema<MessageType::MSG, "MSG", Text<" FROM ", 20>, Content<" IS ", 1400>>;
+    static constexpr MessageType type = Schema::type;
+    uint16_t messageID;
+    FixedString<20> display_name;
+    FixedString<1400> message_content;
 
-    public:
-        MsgJOIN(string channelID, string display_name, uint16_t messageID) : Message(messageID), channelID(channelID), display_name(display_name) { this->type = MessageType::JOIN; };
-        vector<uint8_t> UDP_msg() override;
-        string TCP_msg() override;
+    auto fields() const { return tie(this->display_name, this->message_content); }
 };
 
 /**
- * @class MsgMSG
- * @brief A derived class for a message to the server
+ * @brief An error message
+ * 
+ *   1 byte       2 bytes
+ * +--------+--------+--------+-------~~------+---+--------~~---------+---+
+ * |  0xFE  |    MessageID    |  DisplayName  | 0 |  MessageContents  | 0 |
+ * +--------+--------+--------+-------~~------+---+--------~~---------+---+
+ * 
+ * ERR FROM {DisplayName} IS {MessageContent}\r\n
  */
-class MsgMSG : public Message {
-    string display_name;
-    string message_content;
+struct MsgERR {
+    using Schema = WireSchema<MessageType::ERR, "ERR", Text<" FROM ", 20>, Content<" IS ", 1400>>;
+    static constexpr MessageType type = Schema::type;
+    uint16_t messageID;
+    FixedString<20> display_name;
+    FixedString<1400> message_content;
 
-    public:
-        MsgMSG(string display_name, string message_content, uint16_t messageID) : Message(messageID), display_name(display_name), message_content(message_content) { this->type = MessageType::MSG; };
-        vector<uint8_t> UDP_msg() override;
-        string TCP_msg() override;
+    auto fields() const { return tie(this->display_name, this->message_content); }
 };
 
 /**
- * @class MsgERR
- * @brief A derived class for an error message
+ * @brief A goodbye message
+ * 
+ *   1 byte       2 bytes      
+ * +--------+--------+--------+
+ * |  0xFF  |    MessageID    |
+ * +--------+--------+--------+
+ * 
+ * BYE\r\n
  */
-class MsgERR : public Message {
-    string display_name;
-    string message_content;
+struct MsgBYE {
+    using Schema = WireSchema<MessageType::BYE, "BYE">;
+    static constexpr MessageType type = Schema::type;
+    uint16_t messageID;
 
-    public:
-        MsgERR(string display_name, string message_content, uint16_t messageID) : Message(messageID), display_name(display_name), message_content(message_content) { this->type = MessageType::ERR; };
-        vector<uint8_t> UDP_msg() override;
-        string TCP_msg() override;
+    auto fields() const { return tie(); }
 };
 
 /**
- * @class MsgBYE
- * @brief A derived class for a goodbye message
+ * @brief An outgoing message of any type, stored inline (no heap allocation)
  */
-class MsgBYE : public Message {
-    public:
-        MsgBYE(uint16_t messageID) : Message(messageID) { this->type = MessageType::BYE; };
-        vector<uint8_t> UDP_msg() override;
-        string TCP_msg() override;
+using Message = variant<MsgCONFIRM, MsgAUTH, MsgJOIN, MsgMSG, MsgERR, MsgBYE>;
+
+/**
+ * @brief Maximum encoded sizes over all the alternatives of a message variant
+ */
+template <typename>
+struct WireLimits;
+
+template <typename... Msgs>
+struct WireLimits<variant<Msgs...>> {
+    static constexpr size_t UDP_max_size = max({Msgs::Schema::UDP_max_size...});
+    static constexpr size_t TCP_max_size = max({Msgs::Schema::TCP_max_size...});
 };
 
-#endif // MESSAGE_HPP
\ No newline at end of file
+// buffer sizes for the outgoing messages, known at compile time
+inline constexpr size_t UDP_MAX_MSG_SIZE = WireLimits<Message>::UDP_max_size;
+inline constexpr size_t TCP_MAX_MSG_SIZE = WireLimits<Message>::TCP_max_size;
+
+// statically dispatched accessors of the message variant
+inline MessageType get_type(const Message& msg) {
+    return visit([](const auto& m) { return m.type; }, msg);
+}
+inline uint16_t get_msgID(const Message& msg) {
+    return visit([](const auto& m) { return m.messageID; }, msg);
+}
+
+/**
+ * @brief Write the UDP message into the buffer, the encoder is generated from the message schema
+ * 
+ * @param msg Message to write
+ * @param buf Buffer to write the datagram into
+ * @return size_t Length of the datagram, 0 if it does not fit into the buffer
+ */
+template <typename Msg> requires requires { typename Msg::Schema; }
+size_t UDP_serialize_into(const Msg& msg, span<uint8_t> buf) {
+    return apply([&](const auto&... values) { return Msg::Schema::UDP_encode(buf, msg.messageID, values...); }, msg.fields());
+}
+
+/**
+ * @brief Write the TCP message based on the specified ABNF [RFC5234] grammar into the buffer
+ * 
+ * @param msg Message to write
+ * @param buf Buffer to write the message into
+ * @return size_t Length of the message, 0 if it does not fit into the buffer
+ */
+template <typename Msg> requires requires { typename Msg::Schema; }
+size_t TCP_serialize_into(const Msg& msg, span<uint8_t> buf) {
+    return apply([&](const auto&... values) { return Msg::Schema::TCP_encode(buf, values...); }, msg.fields());
+}
+
+inline size_t UDP_serialize_into(const Message& msg, span<uint8_t> buf) {
+    return visit([buf](const auto& m) { return UDP_serialize_into(m, buf); }, msg);
+}
+inline size_t TCP_serialize_into(const Message& msg, span<uint8_t> buf) {
+    return visit([buf](const auto& m) { return TCP_serialize_into(m, buf); }, msg);
+}
+
+#endif // MESSAGE_HPP
@@ -0,0 +1,78 @@
+/**
+ * @file MessageArena.cpp
+ * @brief MessageArena class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "MessageArena.hpp"
+
+MessageArena::MessageArena() : data(ARENA_SLABS * ARENA_SLAB_SIZE), index(ARENA_SLABS), front_idx(0), count(0), head(0), tail(0), reserved(0) {}
+
+
+uint8_t* MessageArena::reserve(size_t len) {
+    size_t need = slabs_for(len) * ARENA_SLAB_SIZE;
+    if (this->count == 0) {
+        this->head = this->tail = 0;
+    }
+
+    // the stored messages lie in [head, tail), or in [head, end) and [0, tail) once wrapped,
+    // the free space must stay non-empty, so that tail == head only for an empty arena
+    if (this->tail >= this->head) {
+        if (this->data.size() - this->tail >= need) {
+            this->reserved = this->tail;
+        }
+        else if (this->head > need) {
+            this->reserved = 0;
+        }
+        else {
+            return nullptr;
+        }
+    }
+    else if (this->head - this->tail > need) {
+        this->reserved = this->tail;
+    }
+    else {
+        return nullptr;
+    }
+    return this->data.data() + this->reserved;
+}
+
+
+bool MessageArena::commit(size_t len) {
+    if (this->count == this->index.size()) {
+        return false;
+    }
+    this->index[(this->front_idx + this->count) % this->index.size()] = { this->reserved, len };
+    this->count++;
+    this->reserved += slabs_for(len > 0 ? len : 1) * ARENA_SLAB_SIZE;
+    this->tail = this->reserved;
+    return true;
+}
+
+
+bool MessageArena::push(const uint8_t* msg, size_t len) {
+    uint8_t* dst = this->reserve(len > 0 ? len : 1);
+    if (dst == nullptr) {
+        return false;
+    }
+    memcpy(dst, msg, len);
+    return this->commit(len);
+}
+
+
+span<const uint8_t> MessageArena::front() const {
+    const Entry& entry = this->index[this->front_idx];
+    return span<const uint8_t>(this->data.data() + entry.offset, entry.len);
+}
+
+
+void MessageArena::pop() {
+    if (this->count == 0) {
+        return;
+    }
+    this->front_idx = (this->front_idx + 1) % this->index.size();
+    this->count--;
+    this->head = this->count > 0 ? this->index[this->front_idx].offset : this->tail;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file MessageArena.hpp
+ * @brief MessageArena class header
+ * 
+ * A FIFO queue of incoming messages stored in a single contiguous byte arena.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef MESSAGEARENA_HPP
+#define MESSAGEARENA_HPP
+
+#include <stdint.h>
+#include <vector>
+#include <span>
+#include <cstring>
+
+#define ARENA_SLAB_SIZE 1500 // fits any datagram (BUFFER_SIZE)
+#define ARENA_SLABS 256
+
+using namespace std;
+
+/**
+ * @class MessageArena
+ * @brief A ring of fixed-size slabs with an offset/length index of the stored messages
+ * 
+ * Messages occupy whole consecutive slabs and never wrap around the end of the arena. Memory is allocated 
+ * once, a message is either written in place (reserve() and commit()) or copied in by push(), and consumed 
+ * in place from the front.
+ * 
+ */
+class MessageArena {
+    /**
+     * @brief Position of a stored message in the arena
+     */
+    struct Entry {
+        size_t offset;
+        size_t len;
+    };
+
+    vector<uint8_t> data;
+    vector<Entry> index; // ring of entries, one slab at least per message
+    size_t front_idx; // index of the first message
+    size_t count; // number of stored messages
+    size_t head; // offset of the first message
+    size_t tail; // offset where the next message is written
+    size_t reserved; // offset of the reserved space
+
+    static size_t slabs_for(size_t len) { return (len + ARENA_SLAB_SIZE - 1) / ARENA_SLAB_SIZE; }
+
+    public:
+        MessageArena();
+
+        /**
+         * @brief Reserve contiguous space for messages to be written in place
+         * 
+         * @param len Number of bytes needed
+         * @return uint8_t* Start of the reserved space, nullptr if there is not enough space
+         */
+        uint8_t* reserve(size_t len);
+
+        /**
+         * @brief Store a message written into the reserved space
+         * 
+         * Consecutive commits store consecutive messages, each starting at the next slab boundary.
+         * 
+         * @param len Length of the message
+         * @return true The message was stored
+         * @return false The index is full, the message is dropped
+         */
+        bool commit(size_t len);
+
+        /**
+         * @brief Copy a message into the arena
+         * 
+         * @return true The message was stored
+         * @return false There is not enough space or the index is full
+         */
+        bool push(const uint8_t* msg, size_t len);
+
+        /**
+         * @return span<const uint8_t> The first message, valid until it is popped
+         */
+        span<const uint8_t> front() const;
+
+        void pop();
+        bool empty() const { return this->count == 0; }
+        size_t size() const { return this->count; }
+};
+
+#endif // MESSAGEARENA_HPP
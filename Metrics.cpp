@@ -0,0 +1,104 @@
+/**
+ * @file Metrics.cpp
+ * @brief Metrics class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "Metrics.hpp"
+#include "ClientState.hpp"
+
+// names of the message types, in the order of type_index()
+static const char* TYPE_NAMES[METRICS_TYPES] = { "CONFIRM", "REPLY", "AUTH", "JOIN", "MSG", "ERR", "BYE", "UNKNOWN" };
+
+static uint64_t value(const Metrics::Counter& counter) {
+    return counter.load(memory_order_relaxed);
+}
+
+
+string Metrics::to_prometheus() const {
+    string out;
+    auto metric = [&out](const char* name, const char* type, const char* help) {
+        out += string("# HELP ipk24chat_") + name + " " + help + "\n";
+        out += string("# TYPE ipk24chat_") + name + " " + type + "\n";
+    };
+    auto sample = [&out](const char* name, uint64_t value, const char* label = nullptr, const char* label_value = nullptr) {
+        out += string("ipk24chat_") + name;
+        if (label != nullptr) {
+            out += string("{") + label + "=\"" + label_value + "\"}";
+        }
+        out += " " + to_string(value) + "\n";
+    };
+
+    metric("bytes_sent_total", "counter", "Bytes sent to the server");
+    sample("bytes_sent_total", value(this->bytes_sent));
+    metric("bytes_received_total", "counter", "Bytes received from the server");
+    sample("bytes_received_total", value(this->bytes_received));
+
+    metric("messages_sent_total", "counter", "Messages sent to the server (without retransmissions)");
+    for (size_t i = 0; i < METRICS_TYPES; i++) {
+        sample("messages_sent_total", value(this->messages_sent[i]), "type", TYPE_NAMES[i]);
+    }
+    metric("messages_received_total", "counter", "Messages received from the server (with duplicates)");
+    for (size_t i = 0; i < METRICS_TYPES; i++) {
+        sample("messages_received_total", value(this->messages_received[i]), "type", TYPE_NAMES[i]);
+    }
+
+    metric("retransmissions_total", "counter", "UDP messages retransmitted after the confirmation timeout");
+    sample("retransmissions_total", value(this->retransmissions));
+    metric("duplicates_total", "counter", "UDP messages dropped as duplicates");
+    sample("duplicates_total", value(this->duplicates));
+    metric("replies_total", "counter", "REPLY messages handled");
+    sample("replies_total", value(this->replies_ok), "result", "OK");
+    sample("replies_total", value(this->replies_nok), "result", "NOK");
+    metric("parse_errors_total", "counter", "Malformed or unknown messages from the server");
+    sample("parse_errors_total", value(this->parse_errors));
+    metric("server_queue_drops_total", "counter", "Messages dropped as the server message queue was full");
+    sample("server_queue_drops_total", value(this->server_queue_drops));
+
+    metric("state_transitions_total", "counter", "Transitions of the client state, by the state entered");
+    for (size_t i = 0; i < METRICS_STATES; i++) {
+        sample("state_transitions_total", value(this->state_transitions[i]), "state", CLIENT_STATE_NAMES[i]);
+    }
+
+    metric("client_queue_depth", "gauge", "Messages waiting in the client message queue");
+    sample("client_queue_depth", value(this->client_queue_depth));
+    metric("server_queue_depth", "gauge", "Messages waiting in the server message queue");
+    sample("server_queue_depth", value(this->server_queue_depth));
+    return out;
+}
+
+
+string Metrics::to_json() const {
+    string out = "{";
+    auto field = [&out](const char* name, uint64_t value) {
+        if (out.back() != '{') {
+            out += ",";
+        }
+        out += string("\"") + name + "\":" + to_string(value);
+    };
+    auto object = [&out](const char* name, auto& counters, const char* const* names) {
+        out += string(",\"") + name + "\":{";
+        for (size_t i = 0; i < counters.size(); i++) {
+            out += string(i > 0 ? "," : "") + "\"" + names[i] + "\":" + to_string(value(counters[i]));
+        }
+        out += "}";
+    };
+
+    field("bytes_sent", value(this->bytes_sent));
+    field("bytes_received", value(this->bytes_received));
+    object("messages_sent", this->messages_sent, TYPE_NAMES);
+    object("messages_received", this->messages_received, TYPE_NAMES);
+    field("retransmissions", value(this->retransmissions));
+    field("duplicates", value(this->duplicates));
+    field("replies_ok", value(this->replies_ok));
+    field("replies_nok", value(this->replies_nok));
+    field("parse_errors", value(this->parse_errors));
+    field("server_queue_drops", value(this->server_queue_drops));
+    object("state_transitions", this->state_transitions, CLIENT_STATE_NAMES);
+    field("client_queue_depth", value(this->client_queue_depth));
+    field("server_queue_depth", value(this->server_queue_depth));
+    out += "}\n";
+    return out;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file Metrics.hpp
+ * @brief Metrics class header
+ * 
+ * Counters and gauges of the client, exported as a Prometheus text or JSON snapshot.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include "Message.hpp"
+
+#include <stdint.h>
+#include <array>
+#include <atomic>
+#include <string>
+
+#define METRICS_TYPES 8 // message types, including an unknown one
+#define METRICS_STATES 6 // ClientState values
+
+using namespace std;
+
+/**
+ * @class Metrics
+ * @brief Counters of the traffic and events of the session, and gauges of the queue depths
+ * 
+ * All values are relaxed atomics: updating one is a single uncontended add, and a snapshot may be taken
+ * at any time (e.g. from another thread) without locking, each value being consistent on its own.
+ * 
+ */
+class Metrics {
+    public:
+        using Counter = atomic<uint64_t>;
+
+        Counter bytes_sent{0};
+        Counter bytes_received{0};
+        array<Counter, METRICS_TYPES> messages_sent{}; // indexed by type_index()
+        array<Counter, METRICS_TYPES> messages_received{};
+        Counter retransmissions{0};
+        Counter duplicates{0}; // UDP messages dropped as already seen
+        Counter replies_ok{0};
+        Counter replies_nok{0};
+        Counter parse_errors{0}; // malformed or unknown messages from the server
+        Counter server_queue_drops{0}; // messages received while the server message queue was full
+        array<Counter, METRICS_STATES> state_transitions{}; // indexed by the ClientState entered
+
+        // gauges, updated when a snapshot is taken
+        Counter client_queue_depth{0};
+        Counter server_queue_depth{0};
+
+        /**
+         * @brief Index of a message type in the per-type counters
+         * 
+         * @param type First byte of the UDP message (MessageType)
+         * @return size_t Index, METRICS_TYPES - 1 for an unknown type
+         */
+        static size_t type_index(uint8_t type) {
+            switch (type) {
+                case MessageType::CONFIRM: return 0;
+                case MessageType::REPLY: return 1;
+                case MessageType::AUTH: return 2;
+                case MessageType::JOIN: return 3;
+                case MessageType::MSG: return 4;
+                case MessageType::ERR: return 5;
+                case MessageType::BYE: return 6;
+                default: return METRICS_TYPES - 1;
+            }
+        }
+
+        /**
+         * @brief Increment a counter
+         */
+        static void add(Counter& counter, uint64_t value = 1) { counter.fetch_add(value, memory_order_relaxed); }
+
+        /**
+         * @brief Set a gauge
+         */
+        static void set(Counter& gauge, uint64_t value) { gauge.store(value, memory_order_relaxed); }
+
+        /**
+         * @return string Snapshot in the Prometheus text exposition format
+         */
+        string to_prometheus() const;
+
+        /**
+         * @return string Snapshot as a JSON object
+         */
+        string to_json() const;
+};
+
+#endif // METRICS_HPP
@@ -0,0 +1,100 @@
+/**
+ * @file MetricsServer.cpp
+ * @brief MetricsServer class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "MetricsServer.hpp"
+#include "OutputSink.hpp"
+
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+MetricsServer::MetricsServer(const string& path) : path(path), listen_fd(-1) {
+    for (int& conn : this->conns) {
+        conn = -1;
+    }
+    if (path.empty()) {
+        return;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        output.err << "ERR: Metrics socket path too long\n";
+        this->path.clear();
+        return;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    // only a socket left over by a previous run is replaced, never another file given by mistake
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            output.err << "ERR: Metrics socket path " << path << " exists and is not a socket\n";
+            this->path.clear();
+            return;
+        }
+        unlink(path.c_str());
+    }
+
+    // the metrics are optional, the chat goes on without them if the socket cannot be set up
+    this->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (this->listen_fd < 0 || bind(this->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 
+            || listen(this->listen_fd, METRICS_MAX_CONNECTIONS) < 0) {
+        output.err << "ERR: Failed to set up the metrics socket " << path << "\n";
+        if (this->listen_fd >= 0) {
+            close(this->listen_fd);
+            this->listen_fd = -1;
+        }
+        this->path.clear();
+    }
+}
+
+MetricsServer::~MetricsServer() {
+    for (int conn : this->conns) {
+        if (conn >= 0) {
+            close(conn);
+        }
+    }
+    if (this->listen_fd >= 0) {
+        close(this->listen_fd);
+        unlink(this->path.c_str());
+    }
+}
+
+
+size_t MetricsServer::poll_fds(struct pollfd* fds) const {
+    size_t n = 0;
+    bool free_slot = false;
+    for (int conn : this->conns) {
+        if (conn >= 0) {
+            fds[n++] = { .fd = conn, .events = POLLIN, .revents = 0 };
+        }
+        else {
+            free_slot = true;
+        }
+    }
+    if (this->listen_fd >= 0 && free_slot) {
+        fds[n++] = { .fd = this->listen_fd, .events = POLLIN, .revents = 0 };
+    }
+    return n;
+}
+
+
+void MetricsServer::accept_conns() {
+    for (int& conn : this->conns) {
+        if (conn >= 0) {
+            continue;
+        }
+        conn = accept4(this->listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (conn < 0) {
+            // no more pending connections
+            return;
+        }
+    }
+}
@@ -0,0 +1,114 @@
+/**
+ * @file MetricsServer.hpp
+ * @brief MetricsServer class header
+ * 
+ * Optional local Unix domain socket serving snapshots of the client metrics, serviced by the main loop.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef METRICSSERVER_HPP
+#define METRICSSERVER_HPP
+
+#include "Metrics.hpp"
+
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+
+#define METRICS_MAX_CONNECTIONS 4 // scrapes served at once, more connections wait in the backlog
+#define METRICS_REQUEST_SIZE 256
+
+using namespace std;
+
+/**
+ * @class MetricsServer
+ * @brief Non-blocking listener of metrics scrapes
+ * 
+ * A scraper connects, sends "json" for a JSON snapshot, anything else (or just shuts down its side) for 
+ * the Prometheus text format, and reads the snapshot until the connection is closed. All sockets are 
+ * non-blocking and polled together with the chat socket, so a scraper never delays the chat traffic.
+ * 
+ */
+class MetricsServer {
+    string path; // socket path, empty if disabled
+    int listen_fd;
+    int conns[METRICS_MAX_CONNECTIONS]; // connected scrapers, -1 for a free slot
+
+    /**
+     * @brief Read the request of a scraper and answer it, the connection is closed afterwards
+     * 
+     * @return true The connection is done (answered or failed)
+     */
+    template <typename Snapshot>
+    bool serve(int fd, Snapshot& snapshot) {
+        char request[METRICS_REQUEST_SIZE];
+        ssize_t len = recv(fd, request, sizeof(request), MSG_DONTWAIT);
+        if (len < 0) {
+            return errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR;
+        }
+        const Metrics& metrics = snapshot();
+        string response = string_view(request, len).starts_with("json") ? metrics.to_json() : metrics.to_prometheus();
+        // the snapshot fits into the socket buffer, a scraper not reading it just gets it truncated
+        send(fd, response.data(), response.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        return true;
+    }
+
+    public:
+        /**
+         * @brief Construct a new MetricsServer object and start listening
+         * 
+         * @param path Path of the Unix domain socket, an existing socket file is replaced (any other file is kept and the metrics are disabled), empty to disable
+         */
+        MetricsServer(const string& path);
+        ~MetricsServer();
+
+        MetricsServer(const MetricsServer&) = delete;
+        MetricsServer& operator=(const MetricsServer&) = delete;
+
+        /**
+         * @brief Fill in the descriptors to poll, the listener only while there is a free connection slot
+         * 
+         * @param fds Room for 1 + METRICS_MAX_CONNECTIONS descriptors
+         * @return size_t Number of descriptors filled in
+         */
+        size_t poll_fds(struct pollfd* fds) const;
+
+        /**
+         * @brief Accept the scrapers and answer their requests, never blocks
+         * 
+         * @param fds Descriptors filled in by poll_fds(), after poll()
+         * @param n Number of the descriptors
+         * @param snapshot Callable returning the const Metrics& to serialize, invoked only when answering
+         */
+        template <typename Snapshot>
+        void handle(const struct pollfd* fds, size_t n, Snapshot&& snapshot) {
+            for (size_t i = 0; i < n; i++) {
+                if (fds[i].revents == 0) {
+                    continue;
+                }
+                if (fds[i].fd == this->listen_fd) {
+                    this->accept_conns();
+                    continue;
+                }
+                for (int& conn : this->conns) {
+                    if (conn == fds[i].fd && this->serve(conn, snapshot)) {
+                        close(conn);
+                        conn = -1;
+                    }
+                }
+            }
+        }
+
+    private:
+        /**
+         * @brief Accept the pending connections while there are free slots
+         */
+        void accept_conns();
+};
+
+#endif // METRICSSERVER_HPP
@@ -0,0 +1,55 @@
+/**
+ * @file OutputSink.cpp
+ * @brief OutputSink class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "OutputSink.hpp"
+
+#include <errno.h>
+
+OutputSink output;
+
+OutputSink::OutputSink() : out(*this, STDOUT_FILENO), err(*this, STDERR_FILENO) {
+    this->buf.reserve(OUTPUT_FLUSH_SIZE);
+    this->immediate = isatty(STDOUT_FILENO) || isatty(STDERR_FILENO);
+}
+
+
+void OutputSink::append(int fd, string_view str) {
+    if (str.empty()) {
+        return;
+    }
+    if (this->segments.empty() || this->segments.back().fd != fd) {
+        this->segments.push_back({fd, 0});
+    }
+    this->buf.append(str);
+    this->segments.back().len += str.size();
+
+    // a terminal shows every line as soon as it is complete, otherwise it is written out once enough output is buffered
+    if ((this->immediate && str.back() == '\n') || this->buf.size() >= OUTPUT_FLUSH_SIZE) {
+        this->flush();
+    }
+}
+
+void OutputSink::flush() {
+    const char* data = this->buf.data();
+    for (const Segment& segment : this->segments) {
+        size_t written = 0;
+        while (written < segment.len) {
+            ssize_t ret = write(segment.fd, data + written, segment.len - written);
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break; // the stream is not writable, its output is dropped
+            }
+            written += ret;
+        }
+        data += segment.len;
+    }
+    this->buf.clear();
+    this->segments.clear();
+}
@@ -0,0 +1,103 @@
+/**
+ * @file OutputSink.hpp
+ * @brief OutputSink class header
+ * 
+ * A buffered sink for the stdout/stderr output of the client, written out in batches.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef OUTPUTSINK_HPP
+#define OUTPUTSINK_HPP
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <concepts>
+#include <charconv>
+#include <unistd.h>
+
+#define OUTPUT_FLUSH_SIZE 65536 // buffered bytes that force a flush
+
+using namespace std;
+
+/**
+ * @class OutputSink
+ * @brief Collects the output lines in a single buffer and writes them out at once
+ * 
+ * The buffer is split into segments, each a run of consecutive output to one stream, so the lines written
+ * to stdout and stderr keep their relative order when flushed, and all consecutive lines to the same stream
+ * take a single write(). The main loop flushes the sink before it waits in poll(). When connected to
+ * a terminal, every complete line is written out immediately instead.
+ * 
+ */
+class OutputSink {
+    /**
+     * @brief A run of output to one stream
+     */
+    struct Segment {
+        int fd;
+        size_t len;
+    };
+
+    string buf;
+    vector<Segment> segments;
+    bool immediate; // write each line out at once (terminal)
+
+    public:
+        /**
+         * @class Stream
+         * @brief One of the output streams of the sink, used like cout/cerr
+         */
+        class Stream {
+            OutputSink& sink;
+            int fd;
+
+            public:
+                Stream(OutputSink& sink, int fd) : sink(sink), fd(fd) {};
+
+                Stream& operator<<(string_view str) { this->sink.append(this->fd, str); return *this; }
+                Stream& operator<<(char c) { this->sink.append(this->fd, string_view(&c, 1)); return *this; }
+                template <integral T> requires (!same_as<T, char> && !same_as<T, bool>)
+                Stream& operator<<(T value) {
+                    char digits[24];
+                    auto result = to_chars(digits, digits + sizeof(digits), value);
+                    this->sink.append(this->fd, string_view(digits, result.ptr - digits));
+                    return *this;
+                }
+        };
+
+        Stream out; // stdout
+        Stream err; // stderr
+
+        OutputSink();
+        ~OutputSink() { this->flush(); }
+
+        OutputSink(const OutputSink&) = delete;
+        OutputSink& operator=(const OutputSink&) = delete;
+
+        /**
+         * @brief Append output to the buffer
+         * 
+         * @param fd STDOUT_FILENO or STDERR_FILENO
+         * @param str Output, copied into the buffer
+         */
+        void append(int fd, string_view str);
+
+        /**
+         * @brief Write the buffered output to the streams, in the order it was appended
+         */
+        void flush();
+
+        /**
+         * @return true There is no output waiting to be written
+         */
+        bool empty() const { return this->segments.empty(); }
+};
+
+// output of the client
+extern OutputSink output;
+
+#endif // OUTPUTSINK_HPP
@@ -0,0 +1,78 @@
+/**
+ * @file RTTEstimator.cpp
+ * @brief RTTEstimator class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "RTTEstimator.hpp"
+
+#include <algorithm>
+
+RTTEstimator::RTTEstimator(int initial_ms) : samples(0), rtt_min(duration::max()), rtt_max(duration::zero()), rtt_sum(duration::zero()), backoffs(0) {
+    this->initial = chrono::milliseconds(max(initial_ms, 1));
+    this->floor = chrono::milliseconds(RTO_MIN_MS);
+    this->ceiling = max(duration(chrono::milliseconds(RTO_MAX_MS)), this->initial);
+    this->srtt = this->rttvar = duration::zero();
+    this->current_rto = this->initial;
+}
+
+
+RTTEstimator::duration RTTEstimator::computed_rto() const {
+    if (this->samples == 0) {
+        return this->initial;
+    }
+    return clamp(this->srtt + 4 * this->rttvar, this->floor, this->ceiling);
+}
+
+
+void RTTEstimator::sample(duration rtt) {
+    if (this->samples == 0) {
+        // first measurement
+        this->srtt = rtt;
+        this->rttvar = rtt / 2;
+    }
+    else {
+        // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - RTT|, SRTT = 7/8 SRTT + 1/8 RTT
+        duration delta = this->srtt > rtt ? this->srtt - rtt : rtt - this->srtt;
+        this->rttvar = (3 * this->rttvar + delta) / 4;
+        this->srtt = (7 * this->srtt + rtt) / 8;
+    }
+    this->samples++;
+    this->current_rto = this->computed_rto();
+
+    this->rtt_min = min(this->rtt_min, rtt);
+    this->rtt_max = max(this->rtt_max, rtt);
+    this->rtt_sum += rtt;
+}
+
+void RTTEstimator::backoff(chrono::steady_clock::time_point now) {
+    if (now < this->backoff_until) {
+        // another message of the same window expired, the messages were sent within one RTO
+        return;
+    }
+    this->backoff_until = now + this->current_rto;
+    this->current_rto = min(this->current_rto * 2, this->ceiling);
+    this->backoffs++;
+}
+
+void RTTEstimator::reset_backoff() {
+    this->current_rto = this->computed_rto();
+}
+
+
+void RTTEstimator::print_stats(OutputSink::Stream& out, bool adaptive) const {
+    using us = chrono::microseconds;
+    auto to_us = [](duration d) { return chrono::duration_cast<us>(d).count(); };
+
+    out << "STATS rtt samples=" << this->samples;
+    if (this->samples > 0) {
+        out << " min_us=" << to_us(this->rtt_min) << " avg_us=" << to_us(this->rtt_sum / this->samples)
+            << " max_us=" << to_us(this->rtt_max) << " srtt_us=" << to_us(this->srtt) << " rttvar_us=" << to_us(this->rttvar);
+    }
+    if (adaptive) {
+        out << " rto_us=" << to_us(this->current_rto) << " backoffs=" << this->backoffs;
+    }
+    out << "\n";
+}
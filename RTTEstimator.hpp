@@ -0,0 +1,100 @@
+/**
+ * @file RTTEstimator.hpp
+ * @brief RTTEstimator class header
+ * 
+ * Round-trip time estimation and the retransmission timeout of the UDP confirmations (RFC6298).
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef RTTESTIMATOR_HPP
+#define RTTESTIMATOR_HPP
+
+#include "OutputSink.hpp"
+
+#include <stdint.h>
+#include <chrono>
+
+#define RTO_MIN_MS 10 // floor of the adaptive timeout
+#define RTO_MAX_MS 5000 // ceiling of the adaptive timeout (unless the initial timeout is higher)
+
+using namespace std;
+
+/**
+ * @class RTTEstimator
+ * @brief Smoothed round-trip time (SRTT) and its variation (RTTVAR), from which the timeout (RTO) is computed
+ * 
+ * RTO = SRTT + 4 * RTTVAR, kept between the floor and the ceiling. Until the first sample, the RTO is the initial
+ * timeout. An expired timeout doubles the RTO (exponential backoff). The messages in flight expire one after another
+ * within one RTO, so that is a single timeout event, backed off only once. Any confirmation shows the server is
+ * reachable again and drops the backoff (as QUIC does, RFC9002), otherwise a lossy link would keep the long timeout
+ * until a message happens to be confirmed without a retransmission.
+ * Only the confirmations of messages that were not retransmitted are sampled (Karn's algorithm), as it is not
+ * known which of the transmissions they confirm.
+ * 
+ */
+class RTTEstimator {
+    using duration = chrono::steady_clock::duration;
+
+    duration initial;
+    duration floor;
+    duration ceiling;
+
+    duration srtt;
+    duration rttvar;
+    duration current_rto;
+    chrono::steady_clock::time_point backoff_until; // expiries before this belong to the last backoff
+
+    // session statistics
+    uint64_t samples;
+    duration rtt_min;
+    duration rtt_max;
+    duration rtt_sum;
+    uint64_t backoffs;
+
+    // RTO without the backoff
+    duration computed_rto() const;
+
+    public:
+        /**
+         * @brief Construct a new RTTEstimator object
+         * 
+         * @param initial_ms Timeout before the first sample (-d)
+         */
+        RTTEstimator(int initial_ms);
+
+        /**
+         * @brief Update the estimate with a measured round trip
+         * 
+         * @param rtt Time from the (only) transmission of a message to its confirmation
+         */
+        void sample(duration rtt);
+
+        /**
+         * @brief Double the timeout after it expired, once per timeout event
+         * 
+         * @param now Time of the expiry
+         */
+        void backoff(chrono::steady_clock::time_point now);
+
+        /**
+         * @brief Drop the backoff after a confirmation, the RTO is computed from the estimate again
+         */
+        void reset_backoff();
+
+        /**
+         * @return duration Current retransmission timeout
+         */
+        duration rto() const { return this->current_rto; }
+
+        /**
+         * @brief Print the RTT statistics of the session
+         * 
+         * @param out Output stream of the sink
+         * @param adaptive The timeout is adaptive, otherwise the RTO is not used and not printed
+         */
+        void print_stats(OutputSink::Stream& out, bool adaptive) const;
+};
+
+#endif // RTTESTIMATOR_HPP
@@ -0,0 +1,70 @@
+/**
+ * @file RingQueue.hpp
+ * @brief RingQueue class template
+ * 
+ * A FIFO queue storing its elements inline in a single circular array.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef RINGQUEUE_HPP
+#define RINGQUEUE_HPP
+
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+/**
+ * @class RingQueue
+ * @brief A FIFO queue over a circular array, the storage is reused and only grows by doubling when full
+ * 
+ * Unlike std::queue (deque), pushing an element does not allocate a node per element for large types.
+ * 
+ */
+template <typename T>
+class RingQueue {
+    vector<T> items;
+    size_t head; // index of the first element
+    size_t count; // number of stored elements
+
+    // move the elements to the start of a new array of the given capacity
+    void resize(size_t capacity) {
+        vector<T> bigger(capacity);
+        for (size_t i = 0; i < this->count; i++) {
+            bigger[i] = move(this->items[(this->head + i) % this->items.size()]);
+        }
+        this->items = move(bigger);
+        this->head = 0;
+    }
+
+    public:
+        RingQueue() : head(0), count(0) {};
+
+        void push(const T& item) {
+            if (this->count == this->items.size()) {
+                this->resize(this->items.empty() ? 16 : this->items.size() * 2); // double the capacity
+            }
+            this->items[(this->head + this->count) % this->items.size()] = item;
+            this->count++;
+        }
+        void pop() {
+            this->head = (this->head + 1) % this->items.size();
+            this->count--;
+        }
+        T& front() { return this->items[this->head]; }
+        const T& front() const { return this->items[this->head]; }
+        bool empty() const { return this->count == 0; }
+        size_t size() const { return this->count; }
+        void clear() { this->head = 0; this->count = 0; }
+
+        // preallocate the storage for the expected number of elements, so pushing up to it never reallocates
+        void reserve(size_t capacity) {
+            if (capacity > this->items.size()) {
+                this->resize(capacity);
+            }
+        }
+};
+
+#endif // RINGQUEUE_HPP
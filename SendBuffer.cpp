@@ -0,0 +1,55 @@
+/**
+ * @file SendBuffer.cpp
+ * @brief SendBuffer class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "SendBuffer.hpp"
+
+#include <errno.h>
+
+SendBuffer::SendBuffer() : data(SEND_BUFFER_SIZE), head(0), tail(0), writes(0), bytes_written(0) {}
+
+
+bool SendBuffer::append(const Message& msg) {
+    if (this->head > 0 && this->data.size() - this->tail < TCP_MAX_MSG_SIZE) {
+        // move the unsent rest of a partial write to the front
+        memmove(this->data.data(), this->data.data() + this->head, this->size());
+        this->tail -= this->head;
+        this->head = 0;
+    }
+    size_t len = TCP_serialize_into(msg, span<uint8_t>(this->data.data() + this->tail, this->data.size() - this->tail));
+    if (len == 0) {
+        return false;
+    }
+    this->tail += len;
+    return true;
+}
+
+
+ssize_t SendBuffer::flush(int sock) {
+    size_t total = 0;
+    while (this->head < this->tail) {
+        ssize_t bytestx = send(sock, this->data.data() + this->head, this->tail - this->head, MSG_NOSIGNAL);
+        this->writes++;
+        if (bytestx < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // the socket buffer is full, the rest is written when the socket is writable again
+                return total;
+            }
+            return -1;
+        }
+        this->head += bytestx;
+        this->bytes_written += bytestx;
+        total += bytestx;
+    }
+    // everything was sent, start from the beginning again
+    this->head = 0;
+    this->tail = 0;
+    return total;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file SendBuffer.hpp
+ * @brief SendBuffer class header
+ * 
+ * An outbound buffer for the TCP byte stream, which coalesces the messages sent together into a single write.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef SENDBUFFER_HPP
+#define SENDBUFFER_HPP
+
+#include "Message.hpp"
+
+#include <stdint.h>
+#include <vector>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#define SEND_BUFFER_SIZE 65536
+
+using namespace std;
+
+/**
+ * @class SendBuffer
+ * @brief A per-connection outbound buffer, the messages are encoded into it and written out together
+ * 
+ * Memory is allocated once. The socket may be non-blocking, the data that could not be written yet stay 
+ * buffered until the next flush. The number of write syscalls and written bytes is counted, 
+ * so the batching can be measured.
+ * 
+ */
+class SendBuffer {
+    vector<uint8_t> data;
+    size_t head; // start of the unsent data
+    size_t tail; // end of the buffered data
+    size_t writes; // number of send() calls
+    size_t bytes_written;
+
+    public:
+        SendBuffer();
+
+        /**
+         * @brief Encode the TCP message at the end of the buffer
+         * 
+         * @param msg Message to append
+         * @return true The message was appended
+         * @return false Not enough space left, the buffer has to be flushed first
+         */
+        bool append(const Message& msg);
+
+        /**
+         * @brief Write as much of the buffered data to the socket as it accepts
+         * 
+         * @param sock Socket to write to
+         * @return ssize_t Number of bytes written (the rest stays buffered if the socket would block), 
+         *                 -1 if send() failed
+         */
+        ssize_t flush(int sock);
+
+        bool empty() const { return this->head == this->tail; }
+        size_t size() const { return this->tail - this->head; }
+        size_t space() const { return this->data.size() - this->size(); }
+        size_t get_writes() const { return this->writes; }
+        size_t get_bytes_written() const { return this->bytes_written; }
+};
+
+#endif // SENDBUFFER_HPP
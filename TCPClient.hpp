@@ -11,9 +11,11 @@
 
 #include "Client.hpp"
 #include "Message.hpp"
+#include "LineFramer.hpp"
+#include "SendBuffer.hpp"
+
+#include <fcntl.h>
 
-#include <algorithm>
-#include <cctype>
 
 using namespace std;
 
@@ -21,56 +23,79 @@ using namespace std;
  * @class TCPClient
  * @brief A class for handling TCP client communication
  * 
- * Inherits from the Client class, implements the virtual methods for TCP communication.
+ * Derives from ClientEngine, implements the transport specific methods for TCP communication.
  * 
  */
-class TCPClient : public Client {
-    vector<uint8_t> delimiter; // delimiter for message splitting
+class TCPClient : public ClientEngine<TCPClient> {
+    friend class ClientEngine<TCPClient>; // uses the window_allows() hook
+    LineFramer framer; // receive buffer, splits the stream into messages by the CRLF delimiter
+    SendBuffer out; // outgoing messages are serialized here and written out in batches
+
+    private:
+        /**
+         * @brief Check if there is room for the message in the outbound buffer
+         * 
+         * When the server does not keep up, the messages wait in the client queue until the buffer drains.
+         * 
+         */
+        bool window_allows(const Message&) { return this->out.space() >= TCP_MAX_MSG_SIZE; }
 
     public:
         /**
          * @brief Construct a new TCPClient object
          * 
-         * Inherits the parent constructor, in addition connects to the server.
+         * Inherits the parent constructor, in addition connects to the server and switches the socket 
+         * to non-blocking mode.
          * 
          */
         TCPClient(const string& transp, const string& server, int port, int timeout, int max_retransmissions);
-        ~TCPClient() override;
+        ~TCPClient();
 
         /**
          * @brief Send a message to the server
          * 
+         * The message is only appended to the outbound buffer, it is written out by flush_sends().
          * If the message is of type BYE, sets the client state to END,
          * if the client state is START, sets the client state to AUTHENTICATE.
          * 
          * @param msg Message to send
          */
-        void send_msg(shared_ptr<Message> msg) override;
+        void send_msg(const Message& msg);
 
         /**
-         * @brief Receive a message from the server
+         * @brief Write the buffered messages to the server by a single send() call
          * 
-         * Calls recv() to receive a data from the server, parses it by a delimeter and pushes the messages
-         * to the server_message_queue.
+         * What the socket does not accept stays buffered, it is written when poll() reports POLLOUT.
          * 
          */
-        void receive_msg() override;
+        void flush_sends();
 
         /**
-         * @brief Process messages from the client stored in the queue
+         * @return true Some messages are still buffered, the socket should be polled for POLLOUT
+         */
+        bool wants_write() const { return !this->out.empty(); }
+
+        /**
+         * @brief Wait until all the buffered messages are written, used when exiting
+         */
+        void flush();
+
+        /**
+         * @brief Receive a message from the server
          * 
-         * Sends the messages from the queue to the server if the client is not waiting for a response.
+         * Receives the data from the server into the framer's ring buffer, complete messages are extracted 
+         * from it when the server messages are processed.
          * 
          */
-        void process_client_messages() override;
+        void receive_msg();
 
         /**
          * @brief Process messages from the server stored in the queue
          * 
-         * Parses the incoming messages from the queue and prints relevant information do stdout/stderr.
+         * Parses the complete messages buffered by the framer and prints relevant information do stdout/stderr.
          * 
          */
-        void process_server_messages() override;    
+        void process_server_messages();    
 };
 
 #endif // TCPCLIENT_HPP
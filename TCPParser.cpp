@@ -0,0 +1,56 @@
+/**
+ * @file TCPParser.cpp
+ * @brief Parser of the incoming TCP messages implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "TCPParser.hpp"
+
+
+bool parse_tcp_msg(string_view line, TCPServerMsg& msg, string_view& error) {
+    Tokenizer tokens(line);
+    string_view msg_type = tokens.next();
+    msg.reply_ok = false;
+    msg.display_name = {};
+    msg.content = {};
+
+    if (keyword_equals(msg_type, MsgREPLY::Schema::keyword)) {
+        msg.type = MessageType::REPLY;
+        MsgREPLY::Schema::View reply;
+        string_view unknown;
+        if (!MsgREPLY::Schema::TCP_decode(line, reply, unknown)) {
+            // a result other than OK/NOK has its own error
+            error = unknown.empty() ? "Invalid REPLY message" : unknown;
+            return false;
+        }
+        auto& [result, ref_msgID, content] = reply;
+        msg.reply_ok = result;
+        msg.content = content;
+        return true;
+    }
+    if (keyword_equals(msg_type, MsgERR::Schema::keyword) || keyword_equals(msg_type, MsgMSG::Schema::keyword)) {
+        // ERR and MSG share the layout
+        bool is_err = keyword_equals(msg_type, MsgERR::Schema::keyword);
+        msg.type = is_err ? MessageType::ERR : MessageType::MSG;
+        MsgMSG::Schema::View fields;
+        bool valid = is_err ? MsgERR::Schema::TCP_decode(line, fields) : MsgMSG::Schema::TCP_decode(line, fields);
+        if (!valid) {
+            error = is_err ? "Invalid ERR message" : "Invalid MSG message";
+            return false;
+        }
+        auto& [display_name, content] = fields;
+        msg.display_name = display_name;
+        msg.content = content;
+        return true;
+    }
+    if (keyword_equals(msg_type, MsgBYE::Schema::keyword)) {
+        msg.type = MessageType::BYE;
+        return true;
+    }
+
+    msg.type = MessageType::CONFIRM;
+    error = "Unknown message type";
+    return false;
+}
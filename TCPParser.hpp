@@ -0,0 +1,45 @@
+/**
+ * @file TCPParser.hpp
+ * @brief Parser of the incoming TCP messages header
+ * 
+ * Recognizes the type of the IPK24-CHAT message and decodes it by the TCP decoder generated from its WireSchema. 
+ * The parsed fields point into the parsed line, so nothing is copied or allocated.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef TCPPARSER_HPP
+#define TCPPARSER_HPP
+
+#include "Message.hpp"
+
+#include <string_view>
+
+using namespace std;
+
+/**
+ * @brief A parsed message from the server, the fields are views into the parsed line
+ */
+struct TCPServerMsg {
+    MessageType type; // CONFIRM (not used by TCP) marks an unknown message type
+    bool reply_ok; // REPLY result
+    string_view display_name; // MSG, ERR
+    string_view content; // REPLY, MSG, ERR
+};
+
+/**
+ * @brief Parse a line received from the server
+ * 
+ * According to RFC5234, the keywords are matched case insensitively. The type of the message is filled in
+ * even if the rest of the message is malformed.
+ * 
+ * @param line Line without the delimiter
+ * @param msg Parsed message
+ * @param error Description of the error if the message is malformed
+ * @return true The message is valid
+ * @return false The message is malformed, see error
+ */
+bool parse_tcp_msg(string_view line, TCPServerMsg& msg, string_view& error);
+
+#endif // TCPPARSER_HPP
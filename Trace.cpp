@@ -0,0 +1,107 @@
+/**
+ * @file Trace.cpp
+ * @brief Trace ring and its dump, compiled in only with -DIPK_TRACE
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "Trace.hpp"
+
+#ifdef IPK_TRACE
+
+#include <atomic>
+#include <errno.h>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static TraceRecord ring[TRACE_RING_SIZE];
+static atomic<uint64_t> recorded(0); // next record index, not wrapped
+static atomic<bool> dumped(false);
+static char dump_path[4096] = TRACE_FILE;
+
+
+void trace_record(TraceEvent event, uint16_t msgID, uint8_t state, uint16_t arg) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    // claim a slot, a signal handler recording meanwhile gets the next one
+    uint64_t index = recorded.fetch_add(1, memory_order_relaxed);
+    TraceRecord& record = ring[index & (TRACE_RING_SIZE - 1)];
+    record.timestamp = uint64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+    record.event = static_cast<uint16_t>(event);
+    record.msgID = msgID;
+    record.state = state;
+    record.reserved = 0;
+    record.arg = arg;
+}
+
+
+// write all of the buffer, only async-signal-safe calls
+static bool write_all(int fd, const void* data, size_t len) {
+    const char* bytes = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t ret = write(fd, bytes, len);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += ret;
+        len -= ret;
+    }
+    return true;
+}
+
+void trace_dump() {
+    if (dumped.exchange(true)) {
+        return;
+    }
+    int fd = open(dump_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return;
+    }
+
+    uint64_t total = recorded.load(memory_order_relaxed);
+    uint64_t count = total < TRACE_RING_SIZE ? total : TRACE_RING_SIZE;
+    TraceFileHeader header = {};
+    memcpy(header.magic, "IPKTRACE", 8);
+    header.version = 1;
+    header.record_size = sizeof(TraceRecord);
+    header.recorded = total;
+    header.count = count;
+
+    // the records from the oldest one, the ring may wrap around
+    size_t start = (total - count) & (TRACE_RING_SIZE - 1);
+    size_t first = count < TRACE_RING_SIZE - start ? count : TRACE_RING_SIZE - start;
+    if (write_all(fd, &header, sizeof(header)) && write_all(fd, ring + start, first * sizeof(TraceRecord))) {
+        write_all(fd, ring, (count - first) * sizeof(TraceRecord));
+    }
+    close(fd);
+}
+
+
+// dump the trace on a crash, then let the signal terminate the process as it would
+static void crash_handler(int signum) {
+    trace_dump();
+    signal(signum, SIG_DFL);
+    raise(signum);
+}
+
+void trace_init() {
+    const char* path = getenv("IPK_TRACE_FILE");
+    if (path != nullptr && strlen(path) < sizeof(dump_path)) {
+        strcpy(dump_path, path);
+    }
+    atexit(trace_dump);
+    for (int signum : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+        signal(signum, crash_handler);
+    }
+}
+
+#endif // IPK_TRACE
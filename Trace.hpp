@@ -0,0 +1,125 @@
+/**
+ * @file Trace.hpp
+ * @brief Compile-time trace points
+ * 
+ * Built with -DIPK_TRACE (make trace), the TRACE() points record fixed-size binary events into an in-memory ring,
+ * which is written to a file on exit or crash and decoded by ipk24chat-tracedecode. Otherwise the trace points
+ * compile to nothing, their arguments are not even evaluated.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <stdint.h>
+
+#define TRACE_RING_SIZE 65536 // records, must be a power of two
+#define TRACE_FILE "ipk24chat.trace" // default dump file, overridden by the IPK_TRACE_FILE environment variable
+#define TRACE_NO_STATE 0xFF // state of an event recorded outside of the client
+
+using namespace std;
+
+// trace events: name and meaning of the arg field
+#define TRACE_EVENTS(X) \
+    X(SERVER_ADDRESS)       /* server address resolved, arg = port */ \
+    X(CONNECTED)            /* TCP connection established */ \
+    X(INPUT_AUTH)           /* AUTH message created from the input */ \
+    X(INPUT_JOIN)           /* JOIN message created from the input */ \
+    X(INPUT_MSG)            /* MSG message created from the input */ \
+    X(INPUT_BYE)            /* BYE message created from the input */ \
+    X(POLL_WAIT)            /* main loop waits in poll(), arg = timeout in ms (0xFFFF for none) */ \
+    X(INPUT_PUSH)           /* message pushed to the client message queue, arg = queue depth */ \
+    X(SOCKET_READABLE)      /* data from the server */ \
+    X(PROCESS_CLIENT)       /* processing of the client message queue */ \
+    X(MSG_SENT)             /* message handed to the transport, arg = message type */ \
+    X(WAIT_REPLY)           /* waiting on the reply to AUTH/JOIN */ \
+    X(SEND_BATCH)           /* TCP send buffer written out, arg = bytes (capped) */ \
+    X(TRANSMIT)             /* UDP datagram sent, arg = destination port */ \
+    X(RETRANSMIT)           /* UDP confirmation timed out, arg = retransmission number */ \
+    X(NOT_RESPONDING)       /* UDP retransmissions exhausted */ \
+    X(AUTH_CONFIRMED)       /* UDP AUTH confirmed, arg = dynamic server port */ \
+    X(DATAGRAM)             /* UDP datagram received, arg = source port */ \
+    X(SEND_CONFIRM)         /* UDP CONFIRM queued */ \
+    X(PROCESS_SERVER)       /* processing of the server message queue */ \
+    X(RECV_REPLY)           /* REPLY handled, arg = 1 for OK */ \
+    X(RECV_ERR)             /* ERR received */ \
+    X(RECV_MSG)             /* MSG received */ \
+    X(RECV_BYE)             /* BYE received */ \
+    X(SERVER_CLOSED)        /* TCP connection closed by the server */ \
+    X(SEND_ERR)             /* ERR sent when exiting */ \
+    X(SEND_BYE)             /* BYE sent when exiting */ \
+    X(EXIT)                 /* main loop finished, arg = exit code */
+
+/**
+ * @brief Trace event identifiers
+ */
+enum class TraceEvent : uint16_t {
+#define TRACE_ENUM(name) name,
+    TRACE_EVENTS(TRACE_ENUM)
+#undef TRACE_ENUM
+    COUNT
+};
+
+/**
+ * @brief Names of the trace events, indexed by TraceEvent
+ */
+inline constexpr const char* TRACE_EVENT_NAMES[] = {
+#define TRACE_NAME(name) #name,
+    TRACE_EVENTS(TRACE_NAME)
+#undef TRACE_NAME
+};
+
+/**
+ * @brief One recorded event, as stored in the ring and in the dump file
+ */
+struct TraceRecord {
+    uint64_t timestamp; // CLOCK_MONOTONIC in nanoseconds
+    uint16_t event; // TraceEvent
+    uint16_t msgID;
+    uint8_t state; // ClientState, TRACE_NO_STATE outside of the client
+    uint8_t reserved;
+    uint16_t arg; // event specific value
+};
+static_assert(sizeof(TraceRecord) == 16);
+
+/**
+ * @brief Header of the dump file, followed by the records from the oldest one
+ */
+struct TraceFileHeader {
+    char magic[8]; // "IPKTRACE"
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t recorded; // all events recorded, the ring holds the last TRACE_RING_SIZE of them
+    uint64_t count; // records in the file
+};
+
+#ifdef IPK_TRACE
+
+/**
+ * @brief Record an event into the ring, lock-free, the oldest records are overwritten
+ */
+void trace_record(TraceEvent event, uint16_t msgID, uint8_t state, uint16_t arg = 0);
+
+/**
+ * @brief Set up the dump of the ring on exit and on a crash (SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT)
+ */
+void trace_init();
+
+/**
+ * @brief Write the ring into the dump file, async-signal-safe
+ */
+void trace_dump();
+
+#define TRACE(event, ...) trace_record(TraceEvent::event, __VA_ARGS__)
+#define TRACE_INIT() trace_init()
+
+#else
+
+#define TRACE(event, ...) ((void)0)
+#define TRACE_INIT() ((void)0)
+
+#endif // IPK_TRACE
+
+#endif // TRACE_HPP
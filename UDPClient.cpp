@@ -8,16 +8,46 @@
 
 #include "UDPClient.hpp"
 
+// size of an encoded CONFIRM message
+static constexpr size_t CONFIRM_SIZE = MsgCONFIRM::Schema::UDP_max_size;
+static_assert(MsgREPLY::Schema::UDP_max_size <= ARENA_SLAB_SIZE && MsgMSG::Schema::UDP_max_size <= ARENA_SLAB_SIZE);
 
-UDPClient::UDPClient(const string& transp, const string& server, int port, int timeout, int max_retransmissions) : Client(transp, server, port, timeout, max_retransmissions) {
+UDPClient::UDPClient(const string& transp, const string& server, int port, int timeout, int max_retransmissions, int window_size, int batch_size, bool adaptive_timeout) : ClientEngine(transp, server, port, timeout, max_retransmissions), rtt(timeout) {
     response_addr_len = sizeof(response_addr);
+    this->window_size = window_size > 0 ? window_size : 1;
+    // one extra slot for the ERR message sent on exit regardless of the window
+    this->window = vector<PendingMsg>(this->window_size + 1);
+    this->in_flight = 0;
+    this->adaptive_timeout = adaptive_timeout;
+
+    // batched receive: each datagram gets its own arena slab and sender address
+    this->batch_size = batch_size > 0 ? batch_size : 1;
+    this->rx_iov = vector<struct iovec>(this->batch_size);
+    this->rx_addr = vector<struct sockaddr_in>(this->batch_size);
+    this->rx_hdr = vector<struct mmsghdr>(this->batch_size);
+    for (size_t i = 0; i < this->batch_size; i++) {
+        memset(&this->rx_hdr[i], 0, sizeof(struct mmsghdr));
+        this->rx_hdr[i].msg_hdr.msg_iov = &this->rx_iov[i];
+        this->rx_hdr[i].msg_hdr.msg_iovlen = 1;
+        this->rx_hdr[i].msg_hdr.msg_name = &this->rx_addr[i];
+    }
+
+    // batched CONFIRM messages
+    this->tx_data = vector<uint8_t>(this->batch_size * CONFIRM_SIZE);
+    this->tx_iov = vector<struct iovec>(this->batch_size);
+    this->tx_addr = vector<struct sockaddr_in>(this->batch_size);
+    this->tx_hdr = vector<struct mmsghdr>(this->batch_size);
+    for (size_t i = 0; i < this->batch_size; i++) {
+        this->tx_iov[i] = { .iov_base = this->tx_data.data() + i * CONFIRM_SIZE, .iov_len = CONFIRM_SIZE };
+        memset(&this->tx_hdr[i], 0, sizeof(struct mmsghdr));
+        this->tx_hdr[i].msg_hdr.msg_iov = &this->tx_iov[i];
+        this->tx_hdr[i].msg_hdr.msg_iovlen = 1;
+        this->tx_hdr[i].msg_hdr.msg_name = &this->tx_addr[i];
+    }
+    this->tx_count = 0;
 
-    // set the confirmation timeout
-    struct timeval tv = {
-        .tv_sec = this->timeout / 1000,
-        .tv_usec = (this->timeout % 1000) * 1000
-    };
-    setsockopt(this->sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    // confirmation timeouts are handled by the retransmission timers, the socket itself never blocks
+    fcntl(this->sock, F_SETFL, fcntl(this->sock, F_GETFL, 0) | O_NONBLOCK);
 }
 
 UDPClient::~UDPClient() {
@@ -26,170 +56,271 @@ UDPClient::~UDPClient() {
 
 
 bool UDPClient::msgID_seen(uint16_t msgID) {
-    return this->seen_msg_ids.find(msgID) != this->seen_msg_ids.end();
+    return this->seen_msg_ids.seen(msgID);
 }
 
 void UDPClient::mark_msgID_as_seen(uint16_t msgID) {
-    this->seen_msg_ids.insert(msgID);
+    this->seen_msg_ids.mark(msgID);
 }
 
 
-void UDPClient::send_msg(shared_ptr<Message> msg) {
-
-    ssize_t bytestx, bytesrx;
-    int retransmissions = 0;
-    bool retransmit;
-    bool confirmed = false;
-
-    while (!confirmed) {
-        //if (retransmissions > 0) { cout << "INFO: Retransmission " << retransmissions << "\n"; } // DEBUG
-        retransmit = false;
-    
-        // send message
-        if (this->state == ClientState::START) {
-            // auth message is sent to the specified port
-            //cout << "Client: Sending auth message to specified port\n"; // DEBUG
-            bytestx = sendto(this->sock, msg->UDP_msg().data(), msg->UDP_msg().size(), 0, (struct sockaddr*)&this->server_addr, sizeof(this->server_addr));
-        } else {
-            // other messages are sent to the dynamically assigned port
-            //cout << "Client: Sending message to dyn port\n"; // DEBUG
-            bytestx = sendto(this->sock, msg->UDP_msg().data(), msg->UDP_msg().size(), 0, (struct sockaddr*)&this->response_addr, this->response_addr_len);
-        }
-        // if (bytestx < 0) {
-        //     if (retransmissions < this->max_retransmissions) {
-        //         retransmissions++;
-        //         continue;
-        //     }
-        //     else {
-        //         cerr << "ERR: Failed to send the message\n";
-        //         this->set_state(ClientState::ERROR);
-        //         return;
-        //     }
-        // }
-
-        while (!retransmit) {
-            // receive confirmation
-            memset(this->buffer, 0, BUFFER_SIZE);
-            //cout << "Client: Waiting for confirmation\n"; // DEBUG
-            bytesrx = recvfrom(this->sock, this->buffer, BUFFER_SIZE, 0, (struct sockaddr*)&this->response_addr, &this->response_addr_len);
-            //cout << "Client: Received " << bytesrx << " bytes\n"; // DEBUG
-            if (bytesrx < 0) {
-                if ((errno == EAGAIN || errno == EWOULDBLOCK) && retransmissions < this->max_retransmissions) {
-                    retransmissions++;
-                    retransmit = true;
-                    continue;
-                }
-                else {
-                    //cout << "INFO: Server is not responding\n"; // DEBUG
-                    this->set_state(ClientState::END);
-                    return;
-                }
-            }
-            if (this->buffer[0] == MessageType::CONFIRM) {
-                // check the messageID
-                uint16_t msgID = (this->buffer[1] << 8) | this->buffer[2];
-                if (msgID != msg->get_msgID()) {
-                    continue;
-                }
-                if (msg->get_type() == MessageType::BYE) {
-                    // bye message is confirmed, go to end state
-                    this->state = ClientState::END;
-                }
-                if (this->state == ClientState::START) {
-                    //cout << "Client: Auth message confirmed from port: " << ntohs(this->response_addr.sin_port) << "\n"; // DEBUG
-                    // auth message is confirmed by the server, go to authenticate state
-                    this->state = ClientState::AUTHENTICATE;
-                }
-                confirmed = true;
-                break;
-            }
-            else { // received something else than confirmation, process it
-                //cout << "INFO: Received something else than confirmation\n"; // DEBUG
-                vector<uint8_t> message_data(bytesrx);
-                memcpy(message_data.data(), this->buffer, bytesrx);
-                this->server_msg_queue.push(message_data);
-                process_server_messages();
-            }
+chrono::steady_clock::duration UDPClient::confirm_timeout() const {
+    if (this->adaptive_timeout) {
+        return this->rtt.rto();
+    }
+    return chrono::milliseconds(this->timeout);
+}
+
+
+UDPClient::PendingMsg* UDPClient::find_pending(uint16_t msgID) {
+    for (auto& pending : this->window) {
+        if (pending.used && pending.msgID == msgID) {
+            return &pending;
         }
     }
+    return nullptr;
 }
 
 
-void UDPClient::receive_msg() {
-    memset(this->buffer, 0, BUFFER_SIZE);
-    ssize_t bytesrx = recvfrom(this->sock, this->buffer, BUFFER_SIZE, 0, (struct sockaddr*)&this->response_addr, &this->response_addr_len);
-    if (bytesrx < 0) {
-        cerr << "ERR: Failed to receive message\n";
+void UDPClient::transmit(const PendingMsg& pending) {
+    ssize_t ret;
+    if (this->state == ClientState::START) {
+        // auth message is sent to the specified port
+        TRACE(TRANSMIT, pending.msgID, static_cast<uint8_t>(this->state), ntohs(this->server_addr.sin_port));
+        ret = sendto(this->sock, pending.data, pending.len, 0, (struct sockaddr*)&this->server_addr, sizeof(this->server_addr));
+    } else {
+        // other messages are sent to the dynamically assigned port
+        TRACE(TRANSMIT, pending.msgID, static_cast<uint8_t>(this->state), ntohs(this->response_addr.sin_port));
+        ret = sendto(this->sock, pending.data, pending.len, 0, (struct sockaddr*)&this->response_addr, this->response_addr_len);
+    }
+    if (ret > 0) {
+        Metrics::add(this->metrics.bytes_sent, ret);
+    }
+}
+
+
+void UDPClient::confirm_msg(uint16_t ref_msgID) {
+    PendingMsg* pending = this->find_pending(ref_msgID);
+    if (pending == nullptr) {
+        // confirmation of a message that was already confirmed
         return;
     }
-    
-    //cout << "Client: Message came from port: " << ntohs(this->response_addr.sin_port) << "\n"; // DEBUG
+    auto waited = chrono::steady_clock::now() - pending->sent_at;
+    this->confirm_latency.record(waited);
+    if (pending->retransmissions == 0) {
+        // the round trip is only known when there was a single transmission (Karn's algorithm)
+        this->rtt.sample(waited);
+    }
+    else if (this->adaptive_timeout) {
+        this->rtt.reset_backoff();
+    }
+    if (pending->type == MessageType::BYE) {
+        // bye message is confirmed, go to end state
+        this->set_state(ClientState::END);
+    }
+    if (this->state == ClientState::START) {
+        TRACE(AUTH_CONFIRMED, ref_msgID, static_cast<uint8_t>(this->state), ntohs(this->response_addr.sin_port));
+        // auth message is confirmed by the server, go to authenticate state
+        this->set_state(ClientState::AUTHENTICATE);
+    }
+    pending->used = false;
+    this->in_flight--;
+}
 
-    // convert char buffer to vector<uint8_t>
-    vector<uint8_t> message_data(bytesrx);
-    memcpy(message_data.data(), this->buffer, bytesrx);
-    this->server_msg_queue.push(message_data);
+
+bool UDPClient::window_allows(const Message& msg) {
+    if (get_type(msg) == MessageType::MSG) {
+        return this->in_flight < this->window_size;
+    }
+    return this->in_flight == 0;
 }
 
 
-void UDPClient::process_client_messages() {
-    // send messages only when not waiting on a reply
-    while (!this->waiting_on_reply && !this->client_msg_queue.empty()) { 
-        //cout << "Client: processing client messages\n"; // DEBUG
+void UDPClient::send_msg(const Message& msg) {
+    // take a free slot, the datagram is encoded right into it
+    uint16_t msgID = get_msgID(msg);
+    PendingMsg* slot = this->find_pending(msgID);
+    for (size_t i = 0; slot == nullptr && i < this->window.size(); i++) {
+        if (!this->window[i].used) {
+            slot = &this->window[i];
+        }
+    }
+    if (slot == nullptr) {
+        output.err << "ERR: Send window is full\n";
+        return;
+    }
+    if (!slot->used) {
+        this->in_flight++;
+    }
 
-        auto msg = this->client_msg_queue.front();
+    PendingMsg& pending = *slot;
+    pending.used = true;
+    pending.type = get_type(msg);
+    pending.msgID = msgID;
+    pending.len = UDP_serialize_into(msg, pending.data);
+    pending.retransmissions = 0;
+    pending.sent_at = chrono::steady_clock::now();
+    pending.deadline = pending.sent_at + this->confirm_timeout();
+    this->timers.push({pending.deadline, msgID});
+    this->transmit(pending);
+    Metrics::add(this->metrics.messages_sent[Metrics::type_index(pending.type)]);
+}
 
-        if (msg == nullptr) {
-            this->client_msg_queue.pop();
-            continue;
+
+int UDPClient::next_timeout() {
+    // drop timers of messages that were confirmed meanwhile
+    while (!this->timers.empty()) {
+        PendingMsg* pending = this->find_pending(this->timers.top().second);
+        if (pending != nullptr && pending->deadline == this->timers.top().first) {
+            break;
         }
-        if (msg->get_type() != MessageType::AUTH && !this->auth) {
-            cerr << "ERR: You need to authenticate first\n";
-            this->client_msg_queue.pop();
+        this->timers.pop();
+    }
+    if (this->timers.empty()) {
+        return -1;
+    }
+    auto now = chrono::steady_clock::now();
+    auto deadline = this->timers.top().first;
+    return deadline > now ? chrono::ceil<chrono::milliseconds>(deadline - now).count() : 0;
+}
+
+
+void UDPClient::process_timeouts() {
+    auto now = chrono::steady_clock::now();
+    while (!this->timers.empty() && this->timers.top().first <= now) {
+        auto [deadline, msgID] = this->timers.top();
+        this->timers.pop();
+
+        PendingMsg* slot = this->find_pending(msgID);
+        if (slot == nullptr || slot->deadline != deadline) {
+            // the message was confirmed or the timer was rearmed meanwhile
             continue;
         }
-        if ((msg->get_type() == MessageType::MSG || msg->get_type() == MessageType::JOIN) && this->state != ClientState::OPEN) {
-            cerr << "ERR: Cannot send message in non-open state\n";
-            this->client_msg_queue.pop();
-            continue;
+        PendingMsg& pending = *slot;
+        if (pending.retransmissions >= this->max_retransmissions) {
+            TRACE(NOT_RESPONDING, msgID, static_cast<uint8_t>(this->state));
+            this->set_state(ClientState::END);
+            return;
         }
-        if (msg->get_type() == MessageType::AUTH && this->auth) { 
-            cerr << "ERR: No need to authenticate, already authenticated\n"; 
-            this->client_msg_queue.pop();
-            continue;
+        pending.retransmissions++;
+        Metrics::add(this->metrics.retransmissions);
+        TRACE(RETRANSMIT, msgID, static_cast<uint8_t>(this->state), pending.retransmissions);
+        if (this->adaptive_timeout) {
+            // the timeout was too short or the network is congested, back off
+            this->rtt.backoff(now);
         }
+        pending.deadline = now + this->confirm_timeout();
+        this->timers.push({pending.deadline, msgID});
+        this->transmit(pending);
+    }
+}
 
-        // send the message
-        this->send_msg(msg);
 
-        if (msg->get_type() == MessageType::AUTH || msg->get_type() == MessageType::JOIN) {
-            //cout << "Client: Waiting on reply\n"; // DEBUG
-            this->waiting_on_reply = true;
+void UDPClient::flush() {
+    // nothing else is sent when exiting, only the messages in flight are waited for
+    this->client_msg_queue = {};
+    this->waiting_on_reply = false;
+
+    while (this->in_flight > 0 && this->state != ClientState::END) {
+        struct pollfd pfd = { .fd = this->sock, .events = POLLIN, .revents = 0 };
+        int ret = poll(&pfd, 1, this->next_timeout());
+        if (ret < 0 && errno != EINTR) {
+            return;
         }
-        else {
-            //cout << "Client: Not waiting on reply -> popping\n"; // DEBUG
-            this->client_msg_queue.pop();
+        if (ret > 0) {
+            this->receive_msg();
+            this->process_server_messages();
         }
-    }    
+        this->process_timeouts();
+    }
+}
+
+
+void UDPClient::receive_msg() {
+    // reserve a slab of the arena for each datagram of the batch, smaller batch if the arena is nearly full
+    size_t batch = this->batch_size;
+    uint8_t* slabs = nullptr;
+    while (batch > 0 && (slabs = this->server_msg_queue.reserve(batch * ARENA_SLAB_SIZE)) == nullptr) {
+        batch /= 2;
+    }
+    if (slabs == nullptr) {
+        // the queue is full, the datagrams wait in the socket until it is processed
+        return;
+    }
+    for (size_t i = 0; i < batch; i++) {
+        this->rx_iov[i] = { .iov_base = slabs + i * ARENA_SLAB_SIZE, .iov_len = ARENA_SLAB_SIZE };
+        this->rx_hdr[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    }
+
+    int received = recvmmsg(this->sock, this->rx_hdr.data(), batch, MSG_DONTWAIT, nullptr);
+    if (received < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            output.err << "ERR: Failed to receive message\n";
+        }
+        return;
+    }
+
+    for (int i = 0; i < received; i++) {
+        // the latest sender is the one to respond to
+        this->response_addr = this->rx_addr[i];
+        this->response_addr_len = this->rx_hdr[i].msg_hdr.msg_namelen;
+        TRACE(DATAGRAM, 0, static_cast<uint8_t>(this->state), ntohs(this->response_addr.sin_port));
+
+        Metrics::add(this->metrics.bytes_received, this->rx_hdr[i].msg_len);
+        if (!this->server_msg_queue.commit(this->rx_hdr[i].msg_len)) {
+            // not confirmed, so the server retransmits it
+            Metrics::add(this->metrics.server_queue_drops);
+            output.err << "ERR: Server message queue is full, message dropped\n";
+        }
+    }
+}
+
+
+void UDPClient::queue_confirm(uint16_t ref_msgID) {
+    if (this->tx_count == this->batch_size) {
+        this->flush_confirms();
+    }
+    MsgCONFIRM confirm{ref_msgID};
+    UDP_serialize_into(confirm, span<uint8_t>(this->tx_data.data() + this->tx_count * CONFIRM_SIZE, CONFIRM_SIZE));
+    this->tx_addr[this->tx_count] = this->response_addr;
+    this->tx_hdr[this->tx_count].msg_hdr.msg_namelen = this->response_addr_len;
+    this->tx_count++;
+}
+
+
+void UDPClient::flush_confirms() {
+    size_t sent = 0;
+    while (sent < this->tx_count) {
+        int ret = sendmmsg(this->sock, this->tx_hdr.data() + sent, this->tx_count - sent, 0);
+        if (ret <= 0) {
+            // a lost confirmation makes the server retransmit the message
+            break;
+        }
+        sent += ret;
+    }
+    Metrics::add(this->metrics.messages_sent[Metrics::type_index(MessageType::CONFIRM)], sent);
+    Metrics::add(this->metrics.bytes_sent, sent * CONFIRM_SIZE);
+    this->tx_count = 0;
 }
 
 
 void UDPClient::process_server_messages() {
     while (!this->server_msg_queue.empty()) {
-        //cout << "Client: Processing server messages\n"; // DEBUG
+        TRACE(PROCESS_SERVER, 0, static_cast<uint8_t>(this->state));
 
-        // get the current message (FIFO)
-        vector<uint8_t> msg = this->server_msg_queue.front();
+        // get the current message (FIFO), it stays in place until popped
+        span<const uint8_t> msg = this->server_msg_queue.front();
 
         // in case of a message shorter than 3 bytes, skip it
         if (msg.size() < 3) {
+            Metrics::add(this->metrics.parse_errors);
             this->server_msg_queue.pop();
             continue;
         }
 
         // extract the messageID
         uint16_t msgID = (msg[1] << 8) | msg[2];
-        uint16_t ref_msgID;
+        Metrics::add(this->metrics.messages_received[Metrics::type_index(msg[0])]);
 
         // if the messageID was not seen, process the message (packet duplication)
         if (!this->msgID_seen(msgID) || msg[0] == MessageType::CONFIRM) {
@@ -198,8 +329,15 @@ void UDPClient::process_server_messages() {
                 this->mark_msgID_as_seen(msgID);
             }
 
-            size_t idx = 3; // skip the message type and messageID
-            string display_name, message_content;
+            // the fields are decoded by the schema of the message type in place, as views into the arena slab, 
+            // and printed from there without any copy (MSG and ERR fields cannot be missing, a field without 
+            // its terminator ends with the datagram)
+            MsgREPLY::Schema::View reply;
+            MsgMSG::Schema::View fields; // MSG and ERR share the layout
+            auto& [result, ref_msgID, reply_content] = reply;
+            string_view unknown_result; // error of a REPLY result other than OK/NOK
+            auto& [display_name, message_content] = fields;
+
             // process the message based on its type
             switch (msg[0]) {
                 case MessageType::REPLY:
@@ -208,100 +346,104 @@ void UDPClient::process_server_messages() {
                         break;
                     }
                     
-                    //cout << "Client: Received reply\n"; // DEBUG
-                    ref_msgID = (msg[4] << 8) | msg[5];
+                    if (!MsgREPLY::Schema::UDP_decode(msg, reply, unknown_result) && unknown_result.empty()) {
+                        Metrics::add(this->metrics.parse_errors);
+                        output.err << "ERR: Invalid REPLY message\n";
+                        this->error_msg = "Invalid REPLY message";
+                        this->set_state(ClientState::ERROR);
+                        break;
+                    }
                     if (this->get_curr_msgID() != ref_msgID) {
-                        cerr << "ERR: Received reply for wrong message\n";
+                        output.err << "ERR: Received reply for wrong message\n";
                         this->error_msg = "Received reply for wrong message";
                         this->set_state(ClientState::ERROR);
                         break;
                     }
-
-                    message_content = string(msg.begin() + 6, msg.end());
-
-                    if (msg[3] == 0x00) { // !REPLY
-                        cerr << "Failure: " << message_content << "\n";
+                    if (!unknown_result.empty()) {
+                        // the result byte is neither 0 nor 1
+                        Metrics::add(this->metrics.parse_errors);
+                        output.err << "ERR: " << unknown_result << "\n";
+                        this->error_msg = unknown_result;
+                        this->set_state(ClientState::ERROR);
+                        break;
                     }
-                    else if (msg[3] == 0x01) {
-                        cerr << "Success: " << message_content << "\n";
-                        if (this->get_curr_msg()->get_type() == MessageType::AUTH) {
+
+                    TRACE(RECV_REPLY, msgID, static_cast<uint8_t>(this->state), result);
+                    if (result) {
+                        output.err << "Success: " << reply_content << "\n";
+                        if (get_type(this->get_curr_msg()) == MessageType::AUTH) {
                             // successfully authenticated, go to open state
                             this->auth = true;
                             this->set_state(ClientState::OPEN);
                         }
                     }
-                    else {
-                        cerr << "ERR: Unknown reply type\n";
-                        this->error_msg = "Unknown reply type";
-                        this->set_state(ClientState::ERROR);
-                        break;
+                    else { // !REPLY
+                        output.err << "Failure: " << reply_content << "\n";
                     }
-                    this->client_msg_queue.pop(); // remove the message being replied to from the client_queue
-                    this->waiting_on_reply = false; // allow sending another message
+                    this->reply_received(result); // pop the message being replied to, allow sending another message
                     break;
 
                 case MessageType::CONFIRM:
-                    // recieved confirmation for a message that was already confirmed
+                    // confirmation of a pipelined message, or of a message that was already confirmed
+                    this->confirm_msg(msgID);
                     break;
 
                 case MessageType::ERR:
-                    //cout << "Client: Received error\n"; // DEBUG
+                    TRACE(RECV_ERR, msgID, static_cast<uint8_t>(this->state));
                     // ERR FROM DisplayName: MessageContent\n
-                    while (idx < msg.size() && msg[idx] != 0) {
-                        display_name += static_cast<char>(msg[idx]);
-                        ++idx;
-                    }
-                    ++idx; 
-                    while (idx < msg.size() && msg[idx] != 0) {
-                        message_content += static_cast<char>(msg[idx]);
-                        ++idx;
-                    }
-                    cerr << "ERR FROM " << display_name << ": " << message_content << "\n";
+                    MsgERR::Schema::UDP_decode(msg, fields);
+                    output.err << "ERR FROM " << display_name << ": " << message_content << "\n";
                     this->err_received = true;
                     break;
 
                 case MessageType::MSG:
-                    //cout << "Client: Received message\n"; // DEBUG
+                    TRACE(RECV_MSG, msgID, static_cast<uint8_t>(this->state));
                     // DisplayName: MessageContent\n
-                    while (idx < msg.size() && msg[idx] != 0) {
-                        display_name += static_cast<char>(msg[idx]);
-                        ++idx;
-                    }
-                    ++idx; 
-                    while (idx < msg.size() && msg[idx] != 0) {
-                        message_content += static_cast<char>(msg[idx]);
-                        ++idx;
-                    }
-                    cout << display_name << ": " << message_content << "\n";
+                    MsgMSG::Schema::UDP_decode(msg, fields);
+                    output.out << display_name << ": " << message_content << "\n";
                     break;
 
                 case MessageType::BYE:
-                    //cout << "Client: Received bye\n"; // DEBUG
+                    TRACE(RECV_BYE, msgID, static_cast<uint8_t>(this->state));
                     this->set_state(ClientState::END);
                     break;
 
                 default:
                     // unknown message type, set the error state but also confirm it
-                    cerr << "ERR: Unknown message type\n";
+                    Metrics::add(this->metrics.parse_errors);
+                    output.err << "ERR: Unknown message type\n";
                     this->error_msg = "Unknown message type";
                     this->set_state(ClientState::ERROR);
                     break;    
             }
         }
+        else {
+            // already processed, only confirmed again
+            Metrics::add(this->metrics.duplicates);
+        }
 
         // either way, pop the message from the queue and confirm the delivery
+        uint8_t type = msg[0];
         this->server_msg_queue.pop();
 
-        if (msg[0] != MessageType::CONFIRM) {
+        if (type != MessageType::CONFIRM) {
             // confirm the message (not the confirm message though)
-            //cout << "Client: Sending confirmation for messageID " << msgID << "\n"; // DEBUG
-            MsgCONFIRM confirm(msgID);
-            sendto(this->sock, confirm.UDP_msg().data(), confirm.UDP_msg().size(), 0, (struct sockaddr*)&this->response_addr, this->response_addr_len);
+            TRACE(SEND_CONFIRM, msgID, static_cast<uint8_t>(this->state));
+            this->queue_confirm(msgID);
         }
-        if (msg[0] == MessageType::REPLY && this->state != ClientState::ERROR) { 
-            // got reply, handle client messages that came while waiting for reply
+        if ((type == MessageType::REPLY || type == MessageType::CONFIRM) && this->state != ClientState::ERROR) { 
+            // got reply or the send window moved, handle client messages that came while waiting
+            this->flush_confirms();
             process_client_messages(); 
         }
     }
+    this->flush_confirms();
 }
 
+
+void UDPClient::print_stats(OutputSink::Stream& out) const {
+    Client::print_stats(out);
+    this->rtt.print_stats(out, this->adaptive_timeout);
+    this->confirm_latency.print(out, "confirm");
+    out << "STATS udp retransmissions=" << this->metrics.retransmissions.load(memory_order_relaxed) << " timeout=" << (this->adaptive_timeout ? "adaptive" : "fixed") << "\n";
+}
@@ -11,8 +11,12 @@
 
 #include "Client.hpp"
 #include "Message.hpp"
+#include "DuplicateFilter.hpp"
+#include "RTTEstimator.hpp"
 
-#include <set>
+#include <chrono>
+#include <functional>
+#include <fcntl.h>
 
 using namespace std;
 
@@ -20,15 +24,108 @@ using namespace std;
  * @class UDPClient
  * @brief A class for handling UDP client communication
  * 
- * Inherits from the Client class, implements the virtual methods for UDP communication.
+ * Derives from ClientEngine, implements the transport specific methods for UDP communication.
  * 
  */
-class UDPClient : public Client {
+class UDPClient : public ClientEngine<UDPClient> {
+    friend class ClientEngine<UDPClient>; // uses the window_allows() hook
+
+    /**
+     * @brief A sent message that has not been confirmed by the server yet
+     */
+    struct PendingMsg {
+        bool used = false; // false when the slot is free
+        MessageType type;
+        uint16_t msgID;
+        uint8_t data[UDP_MAX_MSG_SIZE]; // encoded datagram, reused for retransmissions
+        size_t len;
+        int retransmissions;
+        chrono::steady_clock::time_point sent_at; // first transmission, for measuring the round trip
+        chrono::steady_clock::time_point deadline; // when the confirmation timeout expires
+    };
+
     struct sockaddr_in response_addr; // holds the dynamically allocated server address
     socklen_t response_addr_len;
-    set<uint16_t> seen_msg_ids; // set of message IDs that have been seen (in case of duplication)
+    DuplicateFilter seen_msg_ids; // message IDs that have been seen (in case of duplication)
+
+    // retransmission timer: deadline and messageID, earliest deadline on top
+    using Timer = pair<chrono::steady_clock::time_point, uint16_t>;
+
+    vector<PendingMsg> window; // slots for unconfirmed messages, allocated once
+    size_t in_flight; // number of used slots
+    size_t window_size; // maximum number of unconfirmed MSG messages in flight
+    priority_queue<Timer, vector<Timer>, greater<Timer>> timers; // stale entries are skipped when they expire
+
+    // round trips of the confirmations, the timeout adapts to them in the adaptive mode (otherwise it is fixed)
+    RTTEstimator rtt;
+    bool adaptive_timeout;
+    LatencyHistogram confirm_latency; // first transmission -> CONFIRM
+
+    // batched datagram I/O (recvmmsg/sendmmsg), buffers are allocated once
+    size_t batch_size; // maximum number of datagrams received or confirmed by one syscall
+    vector<struct iovec> rx_iov;
+    vector<struct sockaddr_in> rx_addr;
+    vector<struct mmsghdr> rx_hdr;
+    vector<uint8_t> tx_data; // batch_size CONFIRM messages
+    vector<struct iovec> tx_iov;
+    vector<struct sockaddr_in> tx_addr;
+    vector<struct mmsghdr> tx_hdr;
+    size_t tx_count; // number of CONFIRM messages waiting to be sent
 
     private:
+        /**
+         * @return chrono::steady_clock::duration Current confirmation timeout, adaptive or the fixed one
+         */
+        chrono::steady_clock::duration confirm_timeout() const;
+
+        /**
+         * @brief Find the slot of an unconfirmed message
+         * 
+         * @param msgID ID of the message
+         * @return PendingMsg* The slot, nullptr if the message is not in flight
+         */
+        PendingMsg* find_pending(uint16_t msgID);
+
+        /**
+         * @brief Send the datagram of a pending message to the server
+         * 
+         * The AUTH message is sent to the specified port, other messages to the dynamically assigned port.
+         * 
+         * @param pending Message to (re)transmit
+         */
+        void transmit(const PendingMsg& pending);
+
+        /**
+         * @brief Handle the confirmation of a sent message
+         * 
+         * Removes the message from the in-flight window, if the message is of type BYE, sets the client state to END,
+         * if the AUTH message is confirmed, sets the client state to AUTHENTICATE.
+         * 
+         * @param ref_msgID ID of the confirmed message
+         */
+        void confirm_msg(uint16_t ref_msgID);
+
+        /**
+         * @brief Add a CONFIRM message to the batch, the batch is sent when full or by flush_confirms()
+         * 
+         * @param ref_msgID ID of the confirmed message
+         */
+        void queue_confirm(uint16_t ref_msgID);
+
+        /**
+         * @brief Send all batched CONFIRM messages by a single sendmmsg() call
+         */
+        void flush_confirms();
+
+        /**
+         * @brief Check if the message can be sent with respect to the send window
+         * 
+         * MSG messages need a free slot in the window, other messages need all the previous messages confirmed.
+         * 
+         * @param msg Message to send
+         */
+        bool window_allows(const Message& msg);
+
         /**
          * @brief Check if the message ID has been seen before
          * 
@@ -49,48 +146,74 @@ class UDPClient : public Client {
         /**
          * @brief Construct a new UDPClient object
          * 
-         * Inherits the parent constructor, in addition sets the confirmation timeout to the socket.
+         * Inherits the parent constructor, in addition switches the socket to non-blocking mode.
          * 
+         * @param window_size Maximum number of MSG messages sent without waiting on their confirmation
+         * @param batch_size Maximum number of datagrams received or confirmed by a single syscall
+         * @param adaptive_timeout Estimate the confirmation timeout from the round trips, the timeout is the initial value
          */
-        UDPClient(const string& transp, const string& server, int port, int timeout, int max_retransmissions);
-        ~UDPClient() override;
+        UDPClient(const string& transp, const string& server, int port, int timeout, int max_retransmissions, int window_size, int batch_size, bool adaptive_timeout);
+        ~UDPClient();
 
         /**
          * @brief Send a message to the server
          * 
-         * If the sending fails (sendto() fails or the confirmation is not received), it retries sending the message 
-         * up to max_retransmissions times. If the message is of type BYE, sets the client state to END, if the AUTH
-         * message is confirmed, sets the client state to AUTHENTICATE. When some other message is recieved while 
-         * waiting on the confirmation, the message is stored to process later.
+         * Sends the datagram and arms its retransmission timer, the call never waits for the confirmation.
          * 
          * @param msg Message to send
          */
-        void send_msg(shared_ptr<Message> msg) override;
+        void send_msg(const Message& msg);
 
         /**
-         * @brief Receive a message from the server
+         * @brief Get the time until the earliest retransmission deadline
          * 
-         * Calls recvfrom() to receive a data from the server and pushes the message to the server_message_queue.
+         * @return int Timeout for poll() in milliseconds, -1 if no message awaits a confirmation
+         */
+        int next_timeout();
+
+        /**
+         * @brief Retransmit every message whose confirmation timeout expired
+         * 
+         * A message is retransmitted up to max_retransmissions times, then the server is considered 
+         * not responding and the client state is set to END.
+         * 
+         */
+        void process_timeouts();
+
+        /**
+         * @brief Wait until all sent messages are confirmed
+         * 
+         * Blocks in poll(), processes incoming messages and retransmits expired ones. Used when exiting, 
+         * so the messages still waiting in the client queue are discarded.
          * 
          */
-        void receive_msg() override;
+        void flush();
 
         /**
-         * @brief Process messages from the client stored in the queue
+         * @brief Receive a message from the server
          * 
-         * Sends the messages from the queue to the server if the client is not waiting for a response.
+         * Calls recvmmsg() to receive up to batch_size datagrams from the server straight into the slabs 
+         * of the server_message_queue.
          * 
          */
-        void process_client_messages() override;
+        void receive_msg();
 
         /**
          * @brief Process messages from the server stored in the queue
          * 
          * Parses the incoming messages from the queue (in case the message ID was not seen therefore the message 
          * is not a duplicate) and prints relevant information do stdout/stderr, also confirms the message.
+         * The confirmations are sent together at the end, before any client message is sent.
+         * 
+         */
+        void process_server_messages();
+
+        /**
+         * @brief Print the client statistics and the round trip statistics of the confirmations
          * 
+         * @param out Output stream of the sink
          */
-        void process_server_messages() override;
+        void print_stats(OutputSink::Stream& out) const;
 };
 
 #endif // UDPCLIENT_HPP
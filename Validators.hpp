@@ -0,0 +1,76 @@
+/**
+ * @file Validators.hpp
+ * @brief Compile-time validators of the user input parameters
+ * 
+ * Each parameter rule of the IPK24-CHAT grammar is a constexpr table of allowed characters and a maximum length,
+ * the input is checked in a single pass without constructing any regex.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef VALIDATORS_HPP
+#define VALIDATORS_HPP
+
+#include <array>
+#include <string_view>
+
+using namespace std;
+
+/**
+ * @brief Set of allowed characters, a lookup table indexed by the byte value
+ */
+struct CharClass {
+    array<bool, 256> allowed;
+
+    // characters in the range [lo, hi]
+    constexpr CharClass(unsigned char lo, unsigned char hi) : allowed{} {
+        for (unsigned c = lo; c <= hi; c++) {
+            this->allowed[c] = true;
+        }
+    }
+    // union of two classes
+    constexpr CharClass operator|(const CharClass& other) const {
+        CharClass result = *this;
+        for (unsigned c = 0; c < 256; c++) {
+            result.allowed[c] = result.allowed[c] || other.allowed[c];
+        }
+        return result;
+    }
+    constexpr bool contains(char c) const { return this->allowed[static_cast<unsigned char>(c)]; }
+};
+
+/**
+ * @brief Validator of a parameter consisting of 1 to MaxLen characters of the Class
+ */
+template <const CharClass& Class, size_t MaxLen>
+constexpr bool matches(string_view input) {
+    if (input.empty() || input.size() > MaxLen) {
+        return false;
+    }
+    for (char c : input) {
+        if (!Class.contains(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline constexpr CharClass ALNUM_DASH = CharClass('A', 'Z') | CharClass('a', 'z') | CharClass('0', '9') | CharClass('-', '-');
+inline constexpr CharClass PRINTABLE = CharClass(0x21, 0x7E); // VCHAR
+inline constexpr CharClass PRINTABLE_SPACE = CharClass(0x20, 0x7E); // VCHAR / SP
+
+// [A-Za-z0-9-]{1,20}
+constexpr bool is_valid_id(string_view input) { return matches<ALNUM_DASH, 20>(input); }
+// [A-Za-z0-9-]{1,128}
+constexpr bool is_valid_secret(string_view input) { return matches<ALNUM_DASH, 128>(input); }
+// [\x21-\x7E]{1,20}
+constexpr bool is_valid_display_name(string_view input) { return matches<PRINTABLE, 20>(input); }
+// [\x20-\x7E]{1,1400}
+constexpr bool is_valid_content(string_view input) { return matches<PRINTABLE_SPACE, 1400>(input); }
+
+static_assert(is_valid_id("xvalik05-2") && !is_valid_id("") && !is_valid_id("a_b") && !is_valid_id("123456789012345678901"));
+static_assert(is_valid_display_name("~Adam!") && !is_valid_display_name("Adam V"));
+static_assert(is_valid_content("hello world!") && !is_valid_content("tab\there") && !is_valid_content("\x7F"));
+
+#endif // VALIDATORS_HPP
@@ -0,0 +1,388 @@
+/**
+ * @file WireSchema.hpp
+ * @brief Compile-time wire schema of the IPK24-CHAT messages
+ * 
+ * Each message type is declared once as a list of fields. The UDP (binary) and TCP (ABNF text) encoders
+ * and decoders and the maximum encoded sizes are all generated from that list at compile time.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef WIRESCHEMA_HPP
+#define WIRESCHEMA_HPP
+
+#include <stdint.h>
+#include <string_view>
+#include <span>
+#include <tuple>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief A string literal usable as a template argument
+ */
+template <size_t N>
+struct Literal {
+    char chars[N];
+
+    constexpr Literal(const char (&str)[N]) { copy_n(str, N, this->chars); }
+    constexpr size_t size() const { return N - 1; }
+    constexpr string_view view() const { return string_view(this->chars, N - 1); }
+};
+
+
+/**
+ * @class WireWriter
+ * @brief Sequential writer of an outgoing message into a fixed caller-provided buffer
+ * 
+ * Never allocates, if the message does not fit into the buffer, the written size is reported as 0.
+ * 
+ */
+class WireWriter {
+    span<uint8_t> buf;
+    size_t pos;
+    bool overflow;
+
+    public:
+        WireWriter(span<uint8_t> buf) : buf(buf), pos(0), overflow(false) {};
+
+        void put(uint8_t byte) {
+            if (this->pos >= this->buf.size()) { this->overflow = true; return; }
+            this->buf[this->pos++] = byte;
+        }
+        void put(string_view str) {
+            if (this->buf.size() - this->pos < str.size()) { this->overflow = true; return; }
+            memcpy(this->buf.data() + this->pos, str.data(), str.size());
+            this->pos += str.size();
+        }
+        // messageID is sent in network byte order
+        void put_msgID(uint16_t msgID) {
+            this->put(static_cast<uint8_t>(msgID >> 8));
+            this->put(static_cast<uint8_t>(msgID & 0xFF));
+        }
+
+        /**
+         * @return size_t Number of bytes written, 0 if the message did not fit into the buffer
+         */
+        size_t size() const { return this->overflow ? 0 : this->pos; }
+};
+
+/**
+ * @class WireReader
+ * @brief Sequential reader of a received datagram, the strings are returned as views into the datagram
+ */
+class WireReader {
+    span<const uint8_t> buf;
+    size_t pos;
+
+    public:
+        WireReader(span<const uint8_t> buf) : buf(buf), pos(0) {};
+
+        bool get(uint8_t& byte) {
+            if (this->pos >= this->buf.size()) return false;
+            byte = this->buf[this->pos++];
+            return true;
+        }
+        bool get_msgID(uint16_t& msgID) {
+            if (this->buf.size() - this->pos < 2) return false;
+            msgID = (this->buf[this->pos] << 8) | this->buf[this->pos + 1];
+            this->pos += 2;
+            return true;
+        }
+        // string up to the zero byte (found by memchr), a string missing its terminator ends with the datagram
+        string_view get_string() {
+            const char* start = reinterpret_cast<const char*>(this->buf.data()) + this->pos;
+            size_t left = this->buf.size() - this->pos;
+            const void* end = memchr(start, 0, left);
+            size_t len = end != nullptr ? static_cast<const char*>(end) - start : left;
+            this->pos += end != nullptr ? len + 1 : len;
+            return string_view(start, len);
+        }
+};
+
+
+// case insensitive comparison of a token with an uppercase keyword
+inline bool keyword_equals(string_view token, string_view keyword) {
+    if (token.size() != keyword.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < token.size(); i++) {
+        if (toupper(static_cast<unsigned char>(token[i])) != keyword[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @class Tokenizer
+ * @brief Splits a TCP message into whitespace separated tokens, the way istringstream >> does
+ */
+class Tokenizer {
+    string_view line;
+    size_t pos;
+
+    public:
+        Tokenizer(string_view line) : line(line), pos(0) {};
+
+        // next token, empty if there is none
+        string_view next() {
+            while (this->pos < this->line.size() && isspace(static_cast<unsigned char>(this->line[this->pos]))) {
+                this->pos++;
+            }
+            size_t start = this->pos;
+            while (this->pos < this->line.size() && !isspace(static_cast<unsigned char>(this->line[this->pos]))) {
+                this->pos++;
+            }
+            return this->line.substr(start, this->pos - start);
+        }
+
+        // check that the next tokens are the keywords of the space separated list
+        bool expect(string_view keywords) {
+            while (!keywords.empty()) {
+                size_t len = min(keywords.find(' '), keywords.size());
+                if (len > 0 && !keyword_equals(this->next(), keywords.substr(0, len))) {
+                    return false;
+                }
+                keywords.remove_prefix(min(len + 1, keywords.size()));
+            }
+            return true;
+        }
+
+        // rest of the line after a single separating space (up to a newline, the way getline does)
+        string_view rest() {
+            string_view rest = this->line.substr(this->pos);
+            if (!rest.empty() && rest[0] == ' ') {
+                rest.remove_prefix(1);
+            }
+            return rest.substr(0, rest.find('\n'));
+        }
+};
+
+
+/**
+ * @brief A string field, zero terminated in UDP, a single token after the Prefix keywords in TCP
+ */
+template <Literal Prefix, size_t MaxLen>
+struct Text {
+    using view_type = string_view;
+    static constexpr size_t UDP_max_size = MaxLen + 1;
+    static constexpr size_t TCP_max_size = Prefix.size() + MaxLen;
+
+    template <typename T>
+    static void check_capacity() {
+        if constexpr (requires { T::capacity; }) {
+            static_assert(T::capacity <= MaxLen, "field storage exceeds the schema length");
+        }
+    }
+    template <typename T>
+    static void UDP_put(WireWriter& msg, const T& value) {
+        check_capacity<T>();
+        msg.put(string_view(value));
+        msg.put(0x00);
+    }
+    template <typename T>
+    static void TCP_put(WireWriter& msg, const T& value) {
+        check_capacity<T>();
+        msg.put(Prefix.view());
+        msg.put(string_view(value));
+    }
+    static bool UDP_get(WireReader& msg, string_view& value, string_view&) {
+        value = msg.get_string();
+        return true;
+    }
+    static bool TCP_get(Tokenizer& tokens, string_view& value, string_view&) {
+        if (!tokens.expect(Prefix.view())) {
+            return false;
+        }
+        value = tokens.next();
+        return !value.empty();
+    }
+};
+
+/**
+ * @brief A message content field, in TCP it spans the rest of the line (may contain spaces)
+ */
+template <Literal Prefix, size_t MaxLen>
+struct Content : Text<Prefix, MaxLen> {
+    static bool TCP_get(Tokenizer& tokens, string_view& value, string_view&) {
+        if (!tokens.expect(Prefix.view())) {
+            return false;
+        }
+        value = tokens.rest();
+        return true;
+    }
+};
+
+/**
+ * @brief A boolean field, a single byte (0/1) in UDP, one of the two keywords in TCP
+ * 
+ * Any other value is reported by its own error (TCPUnknown, UDPUnknown), the value is then false.
+ */
+template <Literal Prefix, Literal Yes, Literal No, Literal TCPUnknown, Literal UDPUnknown>
+struct Flag {
+    using view_type = bool;
+    static constexpr size_t UDP_max_size = 1;
+    static constexpr size_t TCP_max_size = Prefix.size() + max(Yes.size(), No.size());
+
+    static void UDP_put(WireWriter& msg, bool value) { msg.put(static_cast<uint8_t>(value)); }
+    static void TCP_put(WireWriter& msg, bool value) {
+        msg.put(Prefix.view());
+        msg.put(value ? Yes.view() : No.view());
+    }
+    static bool UDP_get(WireReader& msg, bool& value, string_view& unknown) {
+        uint8_t byte;
+        if (!msg.get(byte)) {
+            return false;
+        }
+        if (byte > 1) {
+            unknown = UDPUnknown.view();
+        }
+        value = byte == 1;
+        return true;
+    }
+    static bool TCP_get(Tokenizer& tokens, bool& value, string_view& unknown) {
+        if (!tokens.expect(Prefix.view())) {
+            return false;
+        }
+        string_view token = tokens.next();
+        value = keyword_equals(token, Yes.view());
+        if (!value && !keyword_equals(token, No.view())) {
+            unknown = TCPUnknown.view();
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief A reference to another message ID, present in UDP only
+ */
+struct RefID {
+    using view_type = uint16_t;
+    static constexpr size_t UDP_max_size = 2;
+    static constexpr size_t TCP_max_size = 0;
+
+    static void UDP_put(WireWriter& msg, uint16_t value) { msg.put_msgID(value); }
+    static void TCP_put(WireWriter&, uint16_t) {}
+    static bool UDP_get(WireReader& msg, uint16_t& value, string_view&) { return msg.get_msgID(value); }
+    static bool TCP_get(Tokenizer&, uint16_t& value, string_view&) { value = 0; return true; }
+};
+
+
+/**
+ * @brief Wire layout of a message type
+ * 
+ * UDP: the type byte, the 2-byte message ID and the Fields in order.
+ * TCP: the Keyword followed by the Fields in order and the CRLF delimiter, an empty Keyword means
+ * the message has no TCP form.
+ * 
+ * @tparam Type Message type (the first byte of the UDP message)
+ * @tparam Keyword First token of the TCP message
+ * @tparam Fields Text, Content, Flag or RefID
+ */
+template <auto Type, Literal Keyword, typename... Fields>
+struct WireSchema {
+    static constexpr auto type = Type;
+    static constexpr string_view keyword = Keyword.view();
+
+    // upper bounds of the encoded sizes, for sizing the buffers at compile time
+    static constexpr size_t UDP_max_size = 3 + (Fields::UDP_max_size + ... + 0);
+    static constexpr size_t TCP_max_size = Keyword.size() == 0 ? 0 : Keyword.size() + (Fields::TCP_max_size + ... + 0) + 2;
+
+    /**
+     * @brief Decoded fields, strings are views into the decoded data
+     */
+    using View = tuple<typename Fields::view_type...>;
+
+    /**
+     * @brief Write the UDP message into the buffer
+     *
+     * @return size_t Length of the datagram, 0 if it does not fit into the buffer
+     */
+    template <typename... Values>
+    static size_t UDP_encode(span<uint8_t> buf, uint16_t msgID, const Values&... values) {
+        static_assert(sizeof...(Values) == sizeof...(Fields));
+        WireWriter msg(buf);
+        msg.put(static_cast<uint8_t>(Type));
+        msg.put_msgID(msgID);
+        (Fields::UDP_put(msg, values), ...);
+        return msg.size();
+    }
+
+    /**
+     * @brief Write the TCP message into the buffer
+     *
+     * @return size_t Length of the message, 0 if it does not fit into the buffer or has no TCP form
+     */
+    template <typename... Values>
+    static size_t TCP_encode(span<uint8_t> buf, const Values&... values) {
+        static_assert(sizeof...(Values) == sizeof...(Fields));
+        if constexpr (Keyword.size() == 0) {
+            return 0;
+        }
+        else {
+            WireWriter msg(buf);
+            msg.put(Keyword.view());
+            (Fields::TCP_put(msg, values), ...);
+            msg.put("\r\n");
+            return msg.size();
+        }
+    }
+
+    /**
+     * @brief Decode the fields of a datagram of this type
+     *
+     * @param unknown Set to the error of a field with an unknown value (e.g. the REPLY result), the other fields
+     * are still decoded, empty if the datagram is not of this type or a field is missing
+     * @return true The datagram is of this type and all the fields are present and known
+     */
+    static bool UDP_decode(span<const uint8_t> datagram, View& view, string_view& unknown) {
+        WireReader msg(datagram);
+        uint8_t msg_type;
+        uint16_t msgID;
+        unknown = {};
+        if (!msg.get(msg_type) || msg_type != static_cast<uint8_t>(Type) || !msg.get_msgID(msgID)) {
+            return false;
+        }
+        bool valid = apply([&](auto&... values) { return (Fields::UDP_get(msg, values, unknown) && ...); }, view);
+        if (!valid) {
+            unknown = {};
+        }
+        return valid && unknown.empty();
+    }
+    static bool UDP_decode(span<const uint8_t> datagram, View& view) {
+        string_view unknown;
+        return UDP_decode(datagram, view, unknown);
+    }
+
+    /**
+     * @brief Decode the fields of a TCP message of this type, the keywords are matched case insensitively
+     *
+     * @param line Message without the delimiter
+     * @param unknown Set to the error of a field with an unknown value (e.g. the REPLY result), empty if
+     * the message does not start with the Keyword or a field is missing
+     * @return true The message starts with the Keyword and all the fields are present and known
+     */
+    static bool TCP_decode(string_view line, View& view, string_view& unknown) {
+        Tokenizer tokens(line);
+        unknown = {};
+        if (Keyword.size() == 0 || !keyword_equals(tokens.next(), Keyword.view())) {
+            return false;
+        }
+        bool valid = apply([&](auto&... values) { return (Fields::TCP_get(tokens, values, unknown) && ...); }, view);
+        if (!valid) {
+            unknown = {};
+        }
+        return valid && unknown.empty();
+    }
+    static bool TCP_decode(string_view line, View& view) {
+        string_view unknown;
+        return TCP_decode(line, view, unknown);
+    }
+};
+
+#endif // WIRESCHEMA_HPP
@@ -0,0 +1,88 @@
+/**
+ * @file alloc.cpp
+ * @brief Counting of the heap allocations made by the benchmarks
+ * 
+ * The global operators new and delete are replaced, counting the calls of every plain, array and aligned form.
+ * The nothrow variants of the standard library forward to these, so they are counted as well.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "bench.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+static size_t allocations = 0; // the benchmarks are single-threaded
+
+size_t bench_allocations() {
+    return allocations;
+}
+
+static void* counted_alloc(size_t size, size_t alignment) {
+    allocations++;
+    void* ptr = nullptr;
+    if (alignment <= alignof(max_align_t)) {
+        ptr = malloc(size > 0 ? size : 1);
+    }
+    else if (posix_memalign(&ptr, alignment, size > 0 ? size : 1) != 0) {
+        ptr = nullptr;
+    }
+    if (ptr == nullptr) {
+        throw bad_alloc();
+    }
+    return ptr;
+}
+
+
+void* operator new(size_t size) {
+    return counted_alloc(size, 0);
+}
+
+void* operator new[](size_t size) {
+    return counted_alloc(size, 0);
+}
+
+void* operator new(size_t size, align_val_t alignment) {
+    return counted_alloc(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, align_val_t alignment) {
+    return counted_alloc(size, static_cast<size_t>(alignment));
+}
+
+
+// both malloc and posix_memalign memory is released by free
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, align_val_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, align_val_t) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t, align_val_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, align_val_t) noexcept {
+    free(ptr);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file bench.hpp
+ * @brief Minimal benchmark harness
+ * 
+ * Standalone, no external dependencies. Each benchmark suite is a function declared here and called from main.
+ * Every benchmark is warmed up, then timed in several repetitions, and reported with the spread of the
+ * repetitions and the heap allocations per operation (counted by the replaced operator new, see alloc.cpp).
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define BENCH_REPETITIONS 5 // timed repetitions of each benchmark
+#define BENCH_MIN_TIME_MS 100 // minimal duration of one repetition
+
+using namespace std;
+
+// keeps the compiler from optimizing the benchmarked result away
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Measurements of one benchmark
+ */
+struct BenchResult {
+    string name;
+    size_t bytes_per_op; // 0 if throughput is not relevant
+    size_t items_per_op; // 0 if not relevant
+    size_t iterations; // operations per repetition
+    vector<double> ns_per_op; // one value per repetition
+    double allocs_per_op;
+};
+
+/**
+ * @return size_t Number of heap allocations (operator new calls) made so far
+ */
+size_t bench_allocations();
+
+/**
+ * @brief Check whether the benchmark was selected on the command line (--filter)
+ */
+bool bench_selected(const string& name);
+
+/**
+ * @brief Print the result and keep it for the JSON report
+ */
+void bench_report(BenchResult&& result);
+
+/**
+ * @brief Run the operation repeatedly and report its speed
+ * 
+ * The number of iterations is doubled until one repetition takes BENCH_MIN_TIME_MS, which also warms up
+ * the caches, the allocator and the branch predictors. Then BENCH_REPETITIONS repetitions are timed.
+ * 
+ * @param name Name of the benchmark
+ * @param bytes_per_op Bytes processed by one operation, 0 if throughput is not relevant
+ * @param items_per_op Items (lines, messages) processed by one operation, 0 if not relevant
+ * @param op Benchmarked operation
+ */
+template <typename Op>
+void run_bench(const string& name, size_t bytes_per_op, size_t items_per_op, Op&& op) {
+    using clock = chrono::steady_clock;
+    const auto min_time = chrono::milliseconds(BENCH_MIN_TIME_MS);
+    if (!bench_selected(name)) {
+        return;
+    }
+
+    // warmup and calibration
+    op();
+    size_t iterations = 1;
+    while (true) {
+        auto start = clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            op();
+        }
+        if (clock::now() - start >= min_time) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    BenchResult result = { name, bytes_per_op, items_per_op, iterations, {}, 0 };
+    size_t allocations = bench_allocations();
+    for (size_t rep = 0; rep < BENCH_REPETITIONS; rep++) {
+        auto start = clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            op();
+        }
+        auto elapsed = clock::now() - start;
+        result.ns_per_op.push_back(chrono::duration<double, nano>(elapsed).count() / iterations);
+    }
+    result.allocs_per_op = double(bench_allocations() - allocations) / (iterations * BENCH_REPETITIONS);
+    bench_report(move(result));
+}
+
+/**
+ * @brief Write the results of all the benchmarks run so far as a JSON document
+ * 
+ * @return true The file was written
+ */
+bool bench_write_json(const string& path);
+
+// benchmark suites
+void bench_encode();
+void bench_crlf();
+void bench_tcp_recv();
+void bench_input();
+void bench_udp();
+void bench_tcp();
+
+#endif // BENCH_HPP
@@ -0,0 +1,47 @@
+/**
+ * @file bench_crlf.cpp
+ * @brief Throughput of the CRLF delimiter search used by the TCP framing
+ * 
+ * Simulates a backlog replay after JOIN: hundreds of KB of MSG lines received at once.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "bench.hpp"
+#include "../CRLFScanner.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+
+// counts the lines of the buffer with the given scanner
+template <typename Scanner>
+static size_t count_lines(const vector<uint8_t>& data, Scanner scan) {
+    size_t lines = 0;
+    const uint8_t* pos = data.data();
+    const uint8_t* end = data.data() + data.size();
+    while ((pos = scan(pos, end)) != end) {
+        lines++;
+        pos += 2;
+    }
+    return lines;
+}
+
+void bench_crlf() {
+    // 512 KB of chat lines with varying length
+    vector<uint8_t> data;
+    for (size_t i = 0; data.size() < 512 * 1024; i++) {
+        string line = "MSG FROM user" + to_string(i % 50) + " IS " + string(20 + (i * 37) % 200, 'x') + "\r\n";
+        data.insert(data.end(), line.begin(), line.end());
+    }
+
+    // the original framing path: std::search with a two byte delimiter vector
+    vector<uint8_t> delimiter = {'\r', '\n'};
+    run_bench("crlf/std::search", data.size(), 0, [&] {
+        do_not_optimize(count_lines(data, [&](const uint8_t* pos, const uint8_t* end) {
+            return search(pos, end, delimiter.begin(), delimiter.end());
+        }));
+    });
+    run_bench("crlf/memchr", data.size(), 0, [&] { do_not_optimize(count_lines(data, find_crlf)); });
+}
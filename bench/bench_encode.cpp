@@ -0,0 +1,57 @@
+/**
+ * @file bench_encode.cpp
+ * @brief Cost of encoding the outgoing messages
+ * 
+ * A session-like mix of messages (mostly MSG, some JOIN, AUTH and BYE) is encoded into a reused buffer 
+ * by the UDP and TCP codecs generated from the wire schema.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "bench.hpp"
+#include "../Message.hpp"
+
+void bench_encode() {
+    vector<Message> batch;
+    for (size_t i = 0; i < 1000; i++) {
+        uint16_t msgID = static_cast<uint16_t>(i);
+        if (i % 100 == 0) {
+            batch.push_back(MsgAUTH{msgID, string("xvalik05"), string("0123456789abcdef-secret"), string("Adam")});
+        }
+        else if (i % 100 == 50) {
+            batch.push_back(MsgJOIN{msgID, string("discord.general"), string("Adam")});
+        }
+        else if (i % 100 == 99) {
+            batch.push_back(MsgBYE{msgID});
+        }
+        else {
+            batch.push_back(MsgMSG{msgID, string("Adam"), string("chat line number " + to_string(i) + " " + string(i % 200, 'x'))});
+        }
+    }
+
+    uint8_t buf[UDP_MAX_MSG_SIZE > TCP_MAX_MSG_SIZE ? UDP_MAX_MSG_SIZE : TCP_MAX_MSG_SIZE];
+    size_t udp_bytes = 0, tcp_bytes = 0;
+    for (auto& msg : batch) {
+        udp_bytes += UDP_serialize_into(msg, buf);
+        tcp_bytes += TCP_serialize_into(msg, buf);
+    }
+
+    run_bench("encode/UDP_serialize_into", udp_bytes, batch.size(), [&] {
+        size_t total = 0;
+        for (auto& msg : batch) {
+            total += UDP_serialize_into(msg, buf);
+        }
+        do_not_optimize(buf);
+        do_not_optimize(total);
+    });
+
+    run_bench("encode/TCP_serialize_into", tcp_bytes, batch.size(), [&] {
+        size_t total = 0;
+        for (auto& msg : batch) {
+            total += TCP_serialize_into(msg, buf);
+        }
+        do_not_optimize(buf);
+        do_not_optimize(total);
+    });
+}
@@ -0,0 +1,101 @@
+/**
+ * @file bench_input.cpp
+ * @brief Throughput of the user input validation
+ * 
+ * Compares the original per-call std::regex validation with the compile-time validators,
+ * measures InputHandler::handle_input over a piped script of chat lines, and compares reading the script
+ * line by line with getline() with the bulk InputReader.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "bench.hpp"
+#include "../InputHandler.hpp"
+#include "../Validators.hpp"
+#include "../InputReader.hpp"
+
+#include <regex>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
+
+void bench_input() {
+    // a script of chat messages, as piped to the client
+    vector<string> lines;
+    for (size_t i = 0; i < 100000; i++) {
+        lines.push_back("message number " + to_string(i) + " " + string(i % 120, 'x'));
+    }
+    size_t bytes = 0;
+    for (auto& line : lines) {
+        bytes += line.size();
+    }
+
+    // the original validation: four regex objects constructed for every line (only the first 1k lines, it is slow)
+    size_t regex_lines = 1000;
+    run_bench("input/regex per line", 0, regex_lines, [&] {
+        size_t valid = 0;
+        for (size_t i = 0; i < regex_lines; i++) {
+            const string& line = lines[i];
+            regex username_channelID_pattern(R"([A-Za-z0-9-]{1,20})");
+            regex secret_pattern(R"([A-Za-z0-9-]{1,128})");
+            regex display_name_pattern(R"([\x21-\x7E]{1,20})");
+            regex message_content_pattern(R"([\x20-\x7E]{1,1400})");
+            valid += regex_match(line, message_content_pattern);
+        }
+        do_not_optimize(valid);
+    });
+
+    run_bench("input/constexpr validator", bytes, lines.size(), [&] {
+        size_t valid = 0;
+        for (auto& line : lines) {
+            valid += is_valid_content(line);
+        }
+        do_not_optimize(valid);
+    });
+
+    run_bench("input/handle_input", bytes, lines.size(), [&] {
+        InputHandler input_handler;
+        for (auto& line : lines) {
+            do_not_optimize(input_handler.handle_input(line));
+        }
+    });
+
+    // the script as a file redirected to stdin
+    char path[] = "/tmp/ipk24chat-bench-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return;
+    }
+    {
+        ofstream script(path);
+        for (auto& line : lines) {
+            script << line << '\n';
+        }
+    }
+
+    run_bench("input/getline", bytes, lines.size(), [&] {
+        ifstream script(path);
+        string line;
+        size_t count = 0;
+        while (getline(script, line)) {
+            count++;
+        }
+        do_not_optimize(count);
+    });
+
+    run_bench("input/InputReader (mmap)", bytes, lines.size(), [&] {
+        lseek(fd, 0, SEEK_SET);
+        InputReader input(fd);
+        string_view line;
+        size_t count = 0;
+        while (input.next_line(line)) {
+            count++;
+        }
+        do_not_optimize(count);
+    });
+
+    close(fd);
+    unlink(path);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file bench_tcp.cpp
+ * @brief Cost of sending a batch of TCP messages
+ * 
+ * A pasted block of 500 chat lines is sent over a loopback TCP connection, once with a send() per message 
+ * (the original send path) and once coalesced by the SendBuffer. Reports the write syscalls per batch 
+ * and bytes per write.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "bench.hpp"
+#include "../SendBuffer.hpp"
+
+#include <vector>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// connected loopback TCP pair, the first socket writes, the second one reads
+static bool loopback_pair(int& writer, int& reader) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 1) < 0 
+        || getsockname(listener, (struct sockaddr*)&addr, &len) < 0) {
+        close(listener);
+        return false;
+    }
+    writer = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(writer, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(listener);
+        return false;
+    }
+    reader = accept(listener, nullptr, nullptr);
+    close(listener);
+    return reader >= 0;
+}
+
+// read everything the batch wrote
+static void drain(int reader, size_t bytes) {
+    static uint8_t buf[SEND_BUFFER_SIZE];
+    while (bytes > 0) {
+        ssize_t n = recv(reader, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return;
+        }
+        bytes -= n;
+    }
+}
+
+void bench_tcp() {
+    int writer, reader;
+    if (!loopback_pair(writer, reader)) {
+        printf("tcp: cannot create a loopback connection, skipped\n");
+        return;
+    }
+
+    // a pasted block of chat lines
+    vector<Message> batch;
+    size_t bytes = 0;
+    for (size_t i = 0; i < 500; i++) {
+        batch.push_back(MsgMSG{static_cast<uint16_t>(i), string("Disp"), string("pasted line number " + to_string(i))});
+        uint8_t buf[TCP_MAX_MSG_SIZE];
+        bytes += TCP_serialize_into(batch.back(), buf);
+    }
+
+    // the original send path: one send() per message
+    size_t writes = 0, ops = 0;
+    run_bench("tcp/send per message", bytes, batch.size(), [&] {
+        uint8_t buf[TCP_MAX_MSG_SIZE];
+        for (auto& msg : batch) {
+            size_t len = TCP_serialize_into(msg, buf);
+            send(writer, buf, len, 0);
+            writes++;
+        }
+        ops++;
+        drain(reader, bytes);
+    });
+    if (ops > 0) { // not filtered out
+        printf("%-40s %12.1f writes/batch %8.1f B/write\n", "", (double)writes / ops, (double)bytes * ops / writes);
+    }
+
+    SendBuffer out;
+    ops = 0;
+    run_bench("tcp/coalesced SendBuffer", bytes, batch.size(), [&] {
+        for (auto& msg : batch) {
+            if (!out.append(msg)) {
+                out.flush(writer);
+                out.append(msg);
+            }
+        }
+        out.flush(writer);
+        ops++;
+        drain(reader, bytes);
+    });
+    if (ops > 0) {
+        printf("%-40s %12.1f writes/batch %8.1f B/write\n", "", (double)out.get_writes() / ops, (double)out.get_bytes_written() / out.get_writes());
+    }
+
+    close(writer);
+    close(reader);
+}
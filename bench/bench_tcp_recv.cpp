@@ -0,0 +1,86 @@
+/**
+ * @file bench_tcp_recv.cpp
+ * @brief Cost of the TCP receive path: framing the stream and parsing the lines
+ * 
+ * A backlog replay after JOIN (mostly MSG lines, some ERR and REPLY) arrives over a local stream socket 
+ * in 16 KB segments, which do not respect the line boundaries. The LineFramer reads the segments and 
+ * splits them into lines, which are then parsed as TCPClient::process_server_messages does.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "bench.hpp"
+#include "../LineFramer.hpp"
+#include "../TCPParser.hpp"
+
+#include <sys/socket.h>
+
+#define SEGMENT_SIZE 16384
+
+void bench_tcp_recv() {
+    // 512 KB of server lines
+    string data;
+    size_t lines = 0;
+    for (size_t i = 0; data.size() < 512 * 1024; i++, lines++) {
+        if (i % 50 == 0) {
+            data += "REPLY OK IS Join success\r\n";
+        }
+        else if (i % 50 == 25) {
+            data += "ERR FROM Server IS rate limit " + to_string(i) + "\r\n";
+        }
+        else {
+            data += "MSG FROM user" + to_string(i % 50) + " IS " + string(20 + (i * 37) % 200, 'x') + "\r\n";
+        }
+    }
+
+    int socks[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, socks) < 0) {
+        printf("tcp_recv: cannot create a socket pair, skipped\n");
+        return;
+    }
+    int writer = socks[0], reader = socks[1];
+
+    // a segment is written only once the previous one was read, so the writer never blocks
+    LineFramer framer;
+    auto receive = [&](auto&& handle_line) {
+        for (size_t offset = 0; offset < data.size(); offset += SEGMENT_SIZE) {
+            size_t len = min(size_t(SEGMENT_SIZE), data.size() - offset);
+            if (write(writer, data.data() + offset, len) != ssize_t(len)) {
+                return;
+            }
+            size_t received = 0;
+            while (received < len) {
+                ssize_t n = framer.fill(reader);
+                if (n <= 0) {
+                    return;
+                }
+                received += n;
+            }
+            string_view line;
+            while (framer.next_line(line)) {
+                handle_line(line);
+            }
+        }
+    };
+
+    run_bench("tcp_recv/LineFramer framing", data.size(), lines, [&] {
+        size_t count = 0;
+        receive([&](string_view) { count++; });
+        do_not_optimize(count);
+    });
+
+    run_bench("tcp_recv/framing + parse_tcp_msg", data.size(), lines, [&] {
+        size_t valid = 0;
+        receive([&](string_view line) {
+            TCPServerMsg msg;
+            string_view error;
+            valid += parse_tcp_msg(line, msg, error);
+            do_not_optimize(msg);
+        });
+        do_not_optimize(valid);
+    });
+
+    close(writer);
+    close(reader);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file bench_udp.cpp
+ * @brief Throughput of the UDP datagram decoding
+ * 
+ * Compares the original decoding (the datagram copied out of the receive buffer, the fields rebuilt 
+ * byte by byte into strings) with the schema decoder, which finds the terminators with memchr and 
+ * returns views into the datagram. Also compares the original std::set of the seen message IDs with the 
+ * DuplicateFilter bitmap on a stream of IDs with retransmitted duplicates.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "bench.hpp"
+#include "../Message.hpp"
+#include "../DuplicateFilter.hpp"
+
+#include <set>
+#include <vector>
+
+void bench_udp() {
+    // MSG datagrams with contents of various lengths
+    vector<vector<uint8_t>> datagrams;
+    size_t bytes = 0;
+    for (size_t i = 0; i < 1000; i++) {
+        MsgMSG msg{static_cast<uint16_t>(i), string("Server"), string("message number " + to_string(i) + " " + string(i % 1200, 'x'))};
+        vector<uint8_t> datagram(UDP_MAX_MSG_SIZE);
+        datagram.resize(UDP_serialize_into(msg, datagram));
+        bytes += datagram.size();
+        datagrams.push_back(move(datagram));
+    }
+
+    // the original decoding: memset and copy of the receive buffer, fields appended byte by byte
+    run_bench("udp/per-byte decode", bytes, datagrams.size(), [&] {
+        uint8_t buffer[1500];
+        size_t total = 0;
+        for (auto& datagram : datagrams) {
+            memset(buffer, 0, sizeof(buffer));
+            memcpy(buffer, datagram.data(), datagram.size());
+            vector<uint8_t> msg(buffer, buffer + datagram.size());
+            size_t idx = 3;
+            string display_name, message_content;
+            while (idx < msg.size() && msg[idx] != 0) {
+                display_name += static_cast<char>(msg[idx]);
+                ++idx;
+            }
+            ++idx;
+            while (idx < msg.size() && msg[idx] != 0) {
+                message_content += static_cast<char>(msg[idx]);
+                ++idx;
+            }
+            total += display_name.size() + message_content.size();
+        }
+        do_not_optimize(total);
+    });
+
+    run_bench("udp/schema decode", bytes, datagrams.size(), [&] {
+        size_t total = 0;
+        for (auto& datagram : datagrams) {
+            MsgMSG::Schema::View fields;
+            MsgMSG::Schema::UDP_decode(datagram, fields);
+            auto& [display_name, message_content] = fields;
+            total += display_name.size() + message_content.size();
+        }
+        do_not_optimize(total);
+    });
+
+    // a long session: 100k message IDs in order (wrapping around), every tenth one retransmitted later
+    vector<uint16_t> ids;
+    for (size_t i = 0; i < 100000; i++) {
+        ids.push_back(static_cast<uint16_t>(i));
+        if (i % 10 == 0 && i >= 5) {
+            ids.push_back(static_cast<uint16_t>(i - 5));
+        }
+    }
+
+    // the original lookup: a set of all IDs seen so far (which reports the IDs reused after the wrap as duplicates)
+    run_bench("dedup/std::set", 0, ids.size(), [&] {
+        set<uint16_t> seen;
+        size_t duplicates = 0;
+        for (uint16_t msgID : ids) {
+            if (seen.find(msgID) != seen.end()) {
+                duplicates++;
+                continue;
+            }
+            seen.insert(msgID);
+        }
+        do_not_optimize(duplicates);
+    });
+
+    run_bench("dedup/DuplicateFilter", 0, ids.size(), [&] {
+        DuplicateFilter seen;
+        size_t duplicates = 0;
+        for (uint16_t msgID : ids) {
+            if (seen.seen(msgID)) {
+                duplicates++;
+                continue;
+            }
+            seen.mark(msgID);
+        }
+        do_not_optimize(duplicates);
+    });
+}
@@ -0,0 +1,123 @@
+/**
+ * @file main.cpp
+ * @brief Benchmark runner
+ * 
+ * Usage: ./ipk24chat-bench [--filter substring] [--json file]
+ * 
+ * Runs the benchmarks whose name contains the filter (all by default) and prints one line per benchmark:
+ * median time per operation with the relative standard deviation of the repetitions, operations per second,
+ * heap allocations per operation and the throughput. With --json, the results are also written as a JSON
+ * document, to be compared across commits.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static string filter; // run only the benchmarks containing this
+static vector<BenchResult> results;
+
+// summary of the repetitions of a benchmark
+struct BenchStats {
+    double median, mean, min, max, stddev;
+};
+
+static BenchStats stats_of(vector<double> values) {
+    sort(values.begin(), values.end());
+    size_t n = values.size();
+    BenchStats stats = {};
+    stats.median = n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+    stats.min = values.front();
+    stats.max = values.back();
+    for (double value : values) {
+        stats.mean += value / n;
+    }
+    for (double value : values) {
+        stats.stddev += (value - stats.mean) * (value - stats.mean) / (n > 1 ? n - 1 : 1);
+    }
+    stats.stddev = sqrt(stats.stddev);
+    return stats;
+}
+
+
+bool bench_selected(const string& name) {
+    return name.find(filter) != string::npos;
+}
+
+void bench_report(BenchResult&& result) {
+    BenchStats stats = stats_of(result.ns_per_op);
+    printf("%-40s %12.1f ns/op %5.1f%% %14.0f ops/s %8.2f allocs/op", result.name.c_str(), stats.median,
+        stats.stddev / stats.mean * 100, 1e9 / stats.median, result.allocs_per_op);
+    if (result.bytes_per_op > 0) {
+        printf(" %10.1f MB/s", result.bytes_per_op / stats.median * 1e3);
+    }
+    if (result.items_per_op > 0) {
+        printf(" %14.0f items/s", result.items_per_op / stats.median * 1e9);
+    }
+    printf("\n");
+    results.push_back(move(result));
+}
+
+
+// the name as a JSON string
+static string json_string(const string& value) {
+    string out = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+bool bench_write_json(const string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "{\n  \"repetitions\": %d,\n  \"min_time_ms\": %d,\n  \"compiler\": %s,\n  \"benchmarks\": [",
+        BENCH_REPETITIONS, BENCH_MIN_TIME_MS, json_string(__VERSION__).c_str());
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        BenchStats stats = stats_of(result.ns_per_op);
+        fprintf(file, "%s\n    {\"name\": %s, \"iterations\": %zu, ", i > 0 ? "," : "", json_string(result.name).c_str(), result.iterations);
+        fprintf(file, "\"ns_per_op\": {\"median\": %.3f, \"mean\": %.3f, \"min\": %.3f, \"max\": %.3f, \"stddev\": %.3f}, ",
+            stats.median, stats.mean, stats.min, stats.max, stats.stddev);
+        fprintf(file, "\"ops_per_sec\": %.1f, \"allocs_per_op\": %.3f, \"bytes_per_op\": %zu, \"items_per_op\": %zu}",
+            1e9 / stats.median, result.allocs_per_op, result.bytes_per_op, result.items_per_op);
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+
+int main(int argc, char* argv[]) {
+    string json_path;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--filter") == 0) {
+            filter = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--json") == 0) {
+            json_path = argv[i + 1];
+        }
+    }
+
+    bench_encode();
+    bench_crlf();
+    bench_tcp_recv();
+    bench_input();
+    bench_udp();
+    bench_tcp();
+
+    if (!json_path.empty() && !bench_write_json(json_path)) {
+        fprintf(stderr, "ERR: Cannot write %s\n", json_path.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file Impairment.cpp
+ * @brief Impairment class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "Impairment.hpp"
+
+Impairment::Impairment(const ImpairmentOptions& opts) : opts(opts), rng(opts.seed), chance(0.0, 1.0) {
+    this->seq = 0;
+    this->dropped = 0;
+    this->duplicated = 0;
+    this->reordered = 0;
+}
+
+
+void Impairment::push(Clock::time_point due, Packet&& packet) {
+    this->queued_per_fd[packet.fd]++;
+    this->queue.emplace(make_pair(due, this->seq++), move(packet));
+}
+
+
+bool Impairment::drop_incoming() {
+    if (this->roll(this->opts.loss)) {
+        this->dropped++;
+        return true;
+    }
+    return false;
+}
+
+
+void Impairment::send_datagram(int fd, const struct sockaddr_in& addr, span<const uint8_t> data) {
+    if (this->roll(this->opts.loss)) {
+        this->dropped++;
+        return;
+    }
+    auto due = Clock::now() + chrono::milliseconds(this->opts.delay_ms);
+    if (this->roll(this->opts.reorder)) {
+        this->reordered++;
+        due += chrono::milliseconds(REORDER_DELAY_MS);
+    }
+    Packet packet = { fd, true, addr, vector<uint8_t>(data.begin(), data.end()) };
+    if (this->roll(this->opts.duplicate)) {
+        this->duplicated++;
+        this->push(due, Packet(packet));
+    }
+    this->push(due, move(packet));
+}
+
+
+void Impairment::send_stream(int fd, span<const uint8_t> data) {
+    auto due = Clock::now() + chrono::milliseconds(this->opts.delay_ms);
+    this->push(due, { fd, false, {}, vector<uint8_t>(data.begin(), data.end()) });
+}
+
+
+int Impairment::next_timeout() const {
+    if (this->queue.empty()) {
+        return -1;
+    }
+    auto now = Clock::now();
+    auto due = this->queue.begin()->first.first;
+    return due > now ? chrono::ceil<chrono::milliseconds>(due - now).count() : 0;
+}
+
+
+bool Impairment::pop_due(Packet& packet) {
+    if (this->queue.empty() || this->queue.begin()->first.first > Clock::now()) {
+        return false;
+    }
+    auto node = this->queue.extract(this->queue.begin());
+    packet = move(node.mapped());
+    if (--this->queued_per_fd[packet.fd] == 0) {
+        this->queued_per_fd.erase(packet.fd);
+    }
+    return true;
+}
+
+
+size_t Impairment::queued(int fd) const {
+    auto it = this->queued_per_fd.find(fd);
+    return it == this->queued_per_fd.end() ? 0 : it->second;
+}
+
+
+void Impairment::forget(int fd) {
+    for (auto it = this->queue.begin(); it != this->queue.end(); ) {
+        it = it->second.fd == fd ? this->queue.erase(it) : next(it);
+    }
+    this->queued_per_fd.erase(fd);
+}
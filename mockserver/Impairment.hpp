@@ -0,0 +1,125 @@
+/**
+ * @file Impairment.hpp
+ * @brief Impairment class header
+ * 
+ * Emulation of an unreliable network for the mock server: loss, duplication, reordering and added latency 
+ * of the outgoing messages, decided by a seeded generator so that a run can be reproduced.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef IMPAIRMENT_HPP
+#define IMPAIRMENT_HPP
+
+#include <stdint.h>
+#include <chrono>
+#include <map>
+#include <random>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+
+#define REORDER_DELAY_MS 10 // a reordered datagram is held back by this much, so the later ones overtake it
+
+using namespace std;
+
+/**
+ * @brief Parameters of the emulated network
+ */
+struct ImpairmentOptions {
+    double loss; // probability of a datagram being lost (both directions)
+    double reorder; // probability of an outgoing datagram being held back
+    double duplicate; // probability of an outgoing datagram being sent twice
+    int delay_ms; // latency added to every outgoing message (UDP and TCP)
+    unsigned seed;
+};
+
+/**
+ * @class Impairment
+ * @brief Schedules the outgoing messages as the emulated network would deliver them
+ * 
+ * UDP datagrams may be lost, duplicated, reordered and delayed. TCP is a reliable stream, so its data are only 
+ * delayed, in order. The scheduled messages are delivered by the server once they are due.
+ * 
+ */
+class Impairment {
+    public:
+        /**
+         * @brief A scheduled outgoing message
+         */
+        struct Packet {
+            int fd; // socket to send it from
+            bool datagram; // UDP datagram to addr, otherwise data of the TCP stream
+            struct sockaddr_in addr;
+            vector<uint8_t> data;
+        };
+
+        using Clock = chrono::steady_clock;
+
+    private:
+        ImpairmentOptions opts;
+        mt19937 rng;
+        uniform_real_distribution<double> chance;
+
+        map<pair<Clock::time_point, uint64_t>, Packet> queue; // by the due time, then in the order scheduled
+        uint64_t seq;
+        unordered_map<int, size_t> queued_per_fd;
+
+        uint64_t dropped;
+        uint64_t duplicated;
+        uint64_t reordered;
+
+        bool roll(double probability) { return probability > 0 && this->chance(this->rng) < probability; }
+        void push(Clock::time_point due, Packet&& packet);
+
+    public:
+        Impairment(const ImpairmentOptions& opts);
+
+        /**
+         * @brief Decide whether an incoming datagram is lost
+         * 
+         * @return true Drop the datagram
+         */
+        bool drop_incoming();
+
+        /**
+         * @brief Schedule an outgoing datagram, it may be lost, duplicated, reordered and is delayed
+         */
+        void send_datagram(int fd, const struct sockaddr_in& addr, span<const uint8_t> data);
+
+        /**
+         * @brief Schedule outgoing TCP data, it is delayed only
+         */
+        void send_stream(int fd, span<const uint8_t> data);
+
+        /**
+         * @return int Milliseconds until the next message is due, -1 if there is none
+         */
+        int next_timeout() const;
+
+        /**
+         * @brief Take the next message that is due
+         * 
+         * @param packet The message
+         * @return true A message was due
+         */
+        bool pop_due(Packet& packet);
+
+        /**
+         * @return size_t Number of messages scheduled from the socket
+         */
+        size_t queued(int fd) const;
+
+        /**
+         * @brief Drop the messages scheduled from the socket, when it is closed
+         */
+        void forget(int fd);
+
+        uint64_t get_dropped() const { return this->dropped; }
+        uint64_t get_duplicated() const { return this->duplicated; }
+        uint64_t get_reordered() const { return this->reordered; }
+};
+
+#endif // IMPAIRMENT_HPP
@@ -0,0 +1,622 @@
+/**
+ * @file MockServer.cpp
+ * @brief MockServer class implementation
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "MockServer.hpp"
+#include "../Validators.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+
+// buffer for any message the server sends, in either variant
+static constexpr size_t MOCK_MAX_MSG_SIZE = max({UDP_MAX_MSG_SIZE, TCP_MAX_MSG_SIZE, MsgREPLY::Schema::UDP_max_size, MsgREPLY::Schema::TCP_max_size});
+
+static const char* type_name(MessageType type) {
+    switch (type) {
+        case MessageType::CONFIRM: return "CONFIRM";
+        case MessageType::REPLY: return "REPLY";
+        case MessageType::AUTH: return "AUTH";
+        case MessageType::JOIN: return "JOIN";
+        case MessageType::MSG: return "MSG";
+        case MessageType::ERR: return "ERR";
+        case MessageType::BYE: return "BYE";
+        default: return "UNKNOWN";
+    }
+}
+
+
+// decode the fields of a client message of the given type into the views of msg
+template <typename Msg, typename Decode>
+static bool decode_fields(ClientMsg& msg, Decode&& decode) {
+    typename Msg::Schema::View view;
+    msg.type = Msg::type;
+    if (!decode(view)) {
+        return false;
+    }
+    apply([&msg](const auto&... values) {
+        size_t i = 0;
+        ((msg.fields[i++] = values), ...);
+    }, view);
+    return true;
+}
+
+// decode a client message received over TCP, the keywords are matched case insensitively
+static bool decode_tcp(string_view line, ClientMsg& msg) {
+    Tokenizer tokens(line);
+    string_view keyword = tokens.next();
+    msg.msgID = 0;
+    if (keyword_equals(keyword, MsgAUTH::Schema::keyword)) {
+        return decode_fields<MsgAUTH>(msg, [line](auto& view) { return MsgAUTH::Schema::TCP_decode(line, view); });
+    }
+    if (keyword_equals(keyword, MsgJOIN::Schema::keyword)) {
+        return decode_fields<MsgJOIN>(msg, [line](auto& view) { return MsgJOIN::Schema::TCP_decode(line, view); });
+    }
+    if (keyword_equals(keyword, MsgMSG::Schema::keyword)) {
+        return decode_fields<MsgMSG>(msg, [line](auto& view) { return MsgMSG::Schema::TCP_decode(line, view); });
+    }
+    if (keyword_equals(keyword, MsgERR::Schema::keyword)) {
+        return decode_fields<MsgERR>(msg, [line](auto& view) { return MsgERR::Schema::TCP_decode(line, view); });
+    }
+    if (keyword_equals(keyword, MsgBYE::Schema::keyword)) {
+        return decode_fields<MsgBYE>(msg, [line](auto& view) { return MsgBYE::Schema::TCP_decode(line, view); });
+    }
+    msg.type = MessageType::CONFIRM; // marks an unknown type
+    return false;
+}
+
+// decode a client datagram (other than CONFIRM), at least 3 bytes long
+static bool decode_udp(span<const uint8_t> datagram, ClientMsg& msg) {
+    msg.msgID = (datagram[1] << 8) | datagram[2];
+    switch (datagram[0]) {
+        case MessageType::AUTH:
+            return decode_fields<MsgAUTH>(msg, [datagram](auto& view) { return MsgAUTH::Schema::UDP_decode(datagram, view); });
+        case MessageType::JOIN:
+            return decode_fields<MsgJOIN>(msg, [datagram](auto& view) { return MsgJOIN::Schema::UDP_decode(datagram, view); });
+        case MessageType::MSG:
+            return decode_fields<MsgMSG>(msg, [datagram](auto& view) { return MsgMSG::Schema::UDP_decode(datagram, view); });
+        case MessageType::ERR:
+            return decode_fields<MsgERR>(msg, [datagram](auto& view) { return MsgERR::Schema::UDP_decode(datagram, view); });
+        case MessageType::BYE:
+            return decode_fields<MsgBYE>(msg, [datagram](auto& view) { return MsgBYE::Schema::UDP_decode(datagram, view); });
+        default:
+            msg.type = MessageType::CONFIRM;
+            return false;
+    }
+}
+
+// check the field values against the grammar of the protocol
+static bool fields_valid(const ClientMsg& msg) {
+    switch (msg.type) {
+        case MessageType::AUTH:
+            return is_valid_id(msg.fields[0]) && is_valid_display_name(msg.fields[1]) && is_valid_secret(msg.fields[2]);
+        case MessageType::JOIN:
+            return is_valid_id(msg.fields[0]) && is_valid_display_name(msg.fields[1]);
+        case MessageType::MSG:
+        case MessageType::ERR:
+            return is_valid_display_name(msg.fields[0]) && is_valid_content(msg.fields[1]);
+        default:
+            return true;
+    }
+}
+
+
+MockServer::MockServer(const MockServerOptions& opts) : opts(opts), net(opts.impairment) {
+    this->sessions_total = 0;
+    this->received = 0;
+    this->sent = 0;
+    this->retransmissions = 0;
+    this->confirms = 0;
+    this->duplicates = 0;
+    this->malformed = 0;
+    this->flood_sent = 0;
+    this->gave_up = 0;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(opts.port);
+    int reuse = 1;
+
+    this->tcp_listen = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    setsockopt(this->tcp_listen, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(this->tcp_listen, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(this->tcp_listen, SOMAXCONN) < 0) {
+        fprintf(stderr, "ERR: Cannot listen on TCP port %d: %s\n", opts.port, strerror(errno));
+        close(this->tcp_listen);
+        this->tcp_listen = -1;
+    }
+
+    this->udp_listen = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (bind(this->udp_listen, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "ERR: Cannot bind UDP port %d: %s\n", opts.port, strerror(errno));
+        close(this->udp_listen);
+        this->udp_listen = -1;
+    }
+}
+
+MockServer::~MockServer() {
+    for (auto& [fd, session] : this->sessions) {
+        close(fd);
+    }
+    if (this->tcp_listen >= 0) {
+        close(this->tcp_listen);
+    }
+    if (this->udp_listen >= 0) {
+        close(this->udp_listen);
+    }
+}
+
+
+void MockServer::run(const atomic<bool>& interrupt) {
+    vector<struct pollfd> fds;
+    while (!interrupt.load()) {
+        fds.clear();
+        fds.push_back({ .fd = this->tcp_listen, .events = POLLIN, .revents = 0 });
+        fds.push_back({ .fd = this->udp_listen, .events = POLLIN, .revents = 0 });
+        for (auto& [fd, session] : this->sessions) {
+            short events = POLLIN | (session.out.empty() ? 0 : POLLOUT);
+            fds.push_back({ .fd = fd, .events = events, .revents = 0 });
+        }
+
+        int ret = poll(fds.data(), fds.size(), this->next_timeout());
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "ERR: poll: %s\n", strerror(errno));
+            return;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            this->accept_tcp();
+        }
+        if (fds[1].revents & POLLIN) {
+            this->receive_udp_listen();
+        }
+        for (size_t i = 2; i < fds.size(); i++) {
+            auto it = this->sessions.find(fds[i].fd);
+            if (fds[i].revents == 0 || it == this->sessions.end()) {
+                continue;
+            }
+            Session& session = it->second;
+            if (fds[i].revents & POLLOUT) {
+                this->flush_tcp(session);
+            }
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                session.udp ? this->receive_udp(session) : this->receive_tcp(session);
+            }
+        }
+
+        this->process_timeouts();
+        this->flood();
+        this->deliver();
+        this->reap();
+    }
+}
+
+
+int MockServer::next_timeout() const {
+    int timeout = this->net.next_timeout();
+    auto until = [&timeout](Clock::time_point deadline) {
+        auto now = Clock::now();
+        int ms = deadline > now ? chrono::ceil<chrono::milliseconds>(deadline - now).count() : 0;
+        timeout = timeout < 0 ? ms : min(timeout, ms);
+    };
+    if (!this->timers.empty()) {
+        until(get<0>(this->timers.top()));
+    }
+    for (auto& [fd, session] : this->sessions) {
+        if (session.closing) {
+            until(session.linger_until);
+        }
+        else if (this->opts.flood_rate > 0 && session.auth) {
+            // the flood is sent in small batches, one per millisecond
+            until(Clock::now() + chrono::milliseconds(1));
+        }
+    }
+    return timeout;
+}
+
+
+void MockServer::accept_tcp() {
+    while (true) {
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        int fd = accept4(this->tcp_listen, (struct sockaddr*)&addr, &len, SOCK_NONBLOCK);
+        if (fd < 0) {
+            return;
+        }
+        // the messages are written out as soon as they are due, no waiting for the acknowledgements
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        Session& session = this->sessions[fd];
+        session.udp = false;
+        session.fd = fd;
+        session.addr = addr;
+        session.framer = make_unique<LineFramer>();
+        this->sessions_total++;
+        if (this->opts.verbose) {
+            printf("tcp %d: connected from %s:%d\n", fd, inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+        }
+    }
+}
+
+
+void MockServer::receive_udp_listen() {
+    uint8_t datagram[UDP_MAX_MSG_SIZE];
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    ssize_t n;
+    while ((n = recvfrom(this->udp_listen, datagram, sizeof(datagram), 0, (struct sockaddr*)&addr, &len)) >= 0) {
+        len = sizeof(addr);
+        if (this->net.drop_incoming()) {
+            continue;
+        }
+
+        // a retransmitted AUTH of a known client (its confirmation was lost) goes to its session
+        Session* session = nullptr;
+        for (auto& [fd, known] : this->sessions) {
+            if (known.udp && known.addr.sin_addr.s_addr == addr.sin_addr.s_addr && known.addr.sin_port == addr.sin_port) {
+                session = &known;
+            }
+        }
+        if (session == nullptr) {
+            if (n < 3 || datagram[0] != MessageType::AUTH) {
+                this->malformed++;
+                continue;
+            }
+            // handoff: the client is served from its own socket on a dynamic port from now on
+            int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+            struct sockaddr_in local;
+            memset(&local, 0, sizeof(local));
+            local.sin_family = AF_INET;
+            local.sin_addr.s_addr = htonl(INADDR_ANY);
+            if (fd < 0 || bind(fd, (struct sockaddr*)&local, sizeof(local)) < 0) {
+                fprintf(stderr, "ERR: Cannot create the dynamic UDP socket: %s\n", strerror(errno));
+                if (fd >= 0) {
+                    close(fd);
+                }
+                continue;
+            }
+            session = &this->sessions[fd];
+            session->udp = true;
+            session->fd = fd;
+            session->addr = addr;
+            this->sessions_total++;
+            if (this->opts.verbose) {
+                socklen_t local_len = sizeof(local);
+                getsockname(fd, (struct sockaddr*)&local, &local_len);
+                printf("udp %d: %s:%d handed off to port %d\n", fd, inet_ntoa(addr.sin_addr), ntohs(addr.sin_port), ntohs(local.sin_port));
+            }
+        }
+        this->handle_datagram(*session, span<const uint8_t>(datagram, n));
+    }
+}
+
+
+void MockServer::receive_udp(Session& session) {
+    uint8_t datagram[UDP_MAX_MSG_SIZE];
+    ssize_t n;
+    while ((n = recv(session.fd, datagram, sizeof(datagram), 0)) >= 0) {
+        if (this->net.drop_incoming()) {
+            continue;
+        }
+        this->handle_datagram(session, span<const uint8_t>(datagram, n));
+        if (this->sessions.find(session.fd) == this->sessions.end()) {
+            // the session was removed
+            return;
+        }
+    }
+}
+
+
+void MockServer::handle_datagram(Session& session, span<const uint8_t> datagram) {
+    if (datagram.size() < 3) {
+        this->malformed++;
+        return;
+    }
+    uint16_t msgID = (datagram[1] << 8) | datagram[2];
+    if (datagram[0] == MessageType::CONFIRM) {
+        this->confirms++;
+        session.pending.erase(msgID);
+        return;
+    }
+
+    // every message is confirmed, only the first copy is handled
+    this->send_msg(session, MsgCONFIRM{msgID});
+    if (session.seen.seen(msgID)) {
+        this->duplicates++;
+        return;
+    }
+    session.seen.mark(msgID);
+    if (session.closing) {
+        return;
+    }
+
+    ClientMsg msg;
+    if (!decode_udp(datagram, msg) || !fields_valid(msg)) {
+        this->malformed++;
+        this->error(session, "Malformed message");
+        return;
+    }
+    this->handle(session, msg);
+}
+
+
+void MockServer::receive_tcp(Session& session) {
+    ssize_t n = session.framer->fill(session.fd);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return;
+    }
+    if (n <= 0) {
+        // connection closed by the client (or a line longer than the buffer)
+        if (session.auth && !session.closing) {
+            this->announce(session.channel, &session, "Server", session.display_name + " has left " + session.channel + ".");
+        }
+        this->remove_session(session.fd);
+        return;
+    }
+
+    string_view line;
+    while (!session.closing && session.framer->next_line(line)) {
+        ClientMsg msg;
+        if (!decode_tcp(line, msg) || !fields_valid(msg)) {
+            this->malformed++;
+            this->error(session, "Malformed message");
+            return;
+        }
+        this->handle(session, msg);
+    }
+}
+
+
+void MockServer::handle(Session& session, const ClientMsg& msg) {
+    this->received++;
+    if (this->opts.verbose) {
+        printf("%s %d: %s %u %.*s %.*s\n", session.udp ? "udp" : "tcp", session.fd, type_name(msg.type), msg.msgID,
+            (int)msg.fields[0].size(), msg.fields[0].data(), (int)msg.fields[1].size(), msg.fields[1].data());
+    }
+
+    switch (msg.type) {
+        case MessageType::AUTH:
+            if (session.auth) {
+                this->reply(session, false, msg.msgID, "Already authenticated.");
+                break;
+            }
+            session.auth = true;
+            session.last_flood = Clock::now(); // the flood starts now
+            session.display_name = msg.fields[1];
+            session.channel = MOCK_DEFAULT_CHANNEL;
+            this->reply(session, true, msg.msgID, "Auth success.");
+            this->announce(session.channel, nullptr, "Server", session.display_name + " has joined " + session.channel + ".");
+            break;
+
+        case MessageType::JOIN:
+            if (!session.auth) {
+                this->error(session, "Not authenticated");
+                break;
+            }
+            this->announce(session.channel, &session, "Server", session.display_name + " has left " + session.channel + ".");
+            session.display_name = msg.fields[1];
+            session.channel = msg.fields[0];
+            this->reply(session, true, msg.msgID, "Join success.");
+            this->announce(session.channel, nullptr, "Server", session.display_name + " has joined " + session.channel + ".");
+            break;
+
+        case MessageType::MSG:
+            if (!session.auth) {
+                this->error(session, "Not authenticated");
+                break;
+            }
+            session.display_name = msg.fields[0];
+            this->announce(session.channel, &session, session.display_name, msg.fields[1]);
+            break;
+
+        case MessageType::ERR:
+            this->send_msg(session, MsgBYE{});
+            this->close_session(session);
+            break;
+
+        case MessageType::BYE:
+            if (session.auth) {
+                this->announce(session.channel, &session, "Server", session.display_name + " has left " + session.channel + ".");
+            }
+            this->close_session(session);
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+template <typename Msg>
+void MockServer::send_msg(Session& session, Msg msg) {
+    uint8_t buf[MOCK_MAX_MSG_SIZE];
+    if (!session.udp) {
+        if constexpr (Msg::type != MessageType::CONFIRM) {
+            this->sent++;
+            size_t len = TCP_serialize_into(msg, buf);
+            this->net.send_stream(session.fd, span<const uint8_t>(buf, len));
+        }
+        return;
+    }
+
+    if constexpr (Msg::type != MessageType::CONFIRM) {
+        this->sent++;
+        msg.messageID = session.next_msgID++;
+    }
+    size_t len = UDP_serialize_into(msg, buf);
+    if constexpr (Msg::type != MessageType::CONFIRM) {
+        // kept for retransmissions until confirmed
+        Pending& pending = session.pending[msg.messageID];
+        pending.data.assign(buf, buf + len);
+        pending.retransmissions = 0;
+        pending.deadline = Clock::now() + chrono::milliseconds(this->opts.timeout_ms);
+        this->timers.push({pending.deadline, session.fd, msg.messageID});
+    }
+    this->net.send_datagram(session.fd, session.addr, span<const uint8_t>(buf, len));
+}
+
+
+void MockServer::reply(Session& session, bool result, uint16_t ref_msgID, string_view content) {
+    this->send_msg(session, MsgREPLY{0, result, ref_msgID, content});
+}
+
+void MockServer::announce(const string& channel, const Session* except, string_view display_name, string_view content) {
+    for (auto& [fd, session] : this->sessions) {
+        if (&session != except && session.auth && !session.closing && session.channel == channel) {
+            this->send_msg(session, MsgMSG{0, display_name, content});
+        }
+    }
+}
+
+void MockServer::error(Session& session, string_view content) {
+    this->send_msg(session, MsgERR{0, string_view("Server"), content});
+    this->send_msg(session, MsgBYE{});
+    this->close_session(session);
+}
+
+
+void MockServer::close_session(Session& session) {
+    session.closing = true;
+    // a UDP client may retransmit its last messages, they are still confirmed meanwhile
+    int linger = session.udp ? this->opts.timeout_ms * (this->opts.max_retransmissions + 1) : 0;
+    session.linger_until = Clock::now() + chrono::milliseconds(linger);
+}
+
+void MockServer::remove_session(int fd) {
+    if (this->opts.verbose) {
+        printf("%d: closed\n", fd);
+    }
+    this->net.forget(fd);
+    this->sessions.erase(fd);
+    close(fd);
+}
+
+
+void MockServer::process_timeouts() {
+    auto now = Clock::now();
+    while (!this->timers.empty() && get<0>(this->timers.top()) <= now) {
+        auto [deadline, fd, msgID] = this->timers.top();
+        this->timers.pop();
+
+        auto session = this->sessions.find(fd);
+        if (session == this->sessions.end()) {
+            continue;
+        }
+        auto pending = session->second.pending.find(msgID);
+        if (pending == session->second.pending.end() || pending->second.deadline != deadline) {
+            // confirmed meanwhile
+            continue;
+        }
+        if (pending->second.retransmissions >= this->opts.max_retransmissions) {
+            // the client does not confirm, it is gone
+            this->gave_up++;
+            this->remove_session(fd);
+            continue;
+        }
+        pending->second.retransmissions++;
+        pending->second.deadline = now + chrono::milliseconds(this->opts.timeout_ms);
+        this->timers.push({pending->second.deadline, fd, msgID});
+        this->retransmissions++;
+        this->net.send_datagram(fd, session->second.addr, pending->second.data);
+    }
+}
+
+
+void MockServer::flood() {
+    if (this->opts.flood_rate <= 0) {
+        return;
+    }
+    auto now = Clock::now();
+    for (auto& [fd, session] : this->sessions) {
+        if (!session.auth || session.closing || (this->opts.flood_count > 0 && session.flooded >= this->opts.flood_count)) {
+            continue;
+        }
+        session.flood_credit += chrono::duration<double>(now - session.last_flood).count() * this->opts.flood_rate;
+        session.last_flood = now;
+        while (session.flood_credit >= 1 && session.out.size() < MOCK_FLOOD_BACKLOG
+                && (this->opts.flood_count == 0 || session.flooded < this->opts.flood_count)) {
+            session.flood_credit -= 1;
+            this->send_msg(session, MsgMSG{0, string_view(MOCK_FLOOD_NAME), "flood message " + to_string(session.flooded++)});
+            this->flood_sent++;
+        }
+        // no burst after the backlog drains
+        session.flood_credit = min(session.flood_credit, 1.0);
+    }
+}
+
+
+void MockServer::deliver() {
+    Impairment::Packet packet;
+    vector<int> written; // TCP sessions with new data, written out together
+    while (this->net.pop_due(packet)) {
+        if (packet.datagram) {
+            sendto(packet.fd, packet.data.data(), packet.data.size(), 0, (struct sockaddr*)&packet.addr, sizeof(packet.addr));
+            continue;
+        }
+        auto session = this->sessions.find(packet.fd);
+        if (session != this->sessions.end()) {
+            if (session->second.out.empty()) {
+                written.push_back(packet.fd);
+            }
+            session->second.out.append(packet.data.begin(), packet.data.end());
+        }
+    }
+    for (int fd : written) {
+        this->flush_tcp(this->sessions.at(fd));
+    }
+}
+
+
+void MockServer::flush_tcp(Session& session) {
+    while (!session.out.empty()) {
+        ssize_t n = send(session.fd, session.out.data(), session.out.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                // the client is gone, it is removed on the next read
+                session.out.clear();
+            }
+            return;
+        }
+        session.out.erase(0, n);
+    }
+}
+
+
+void MockServer::reap() {
+    auto now = Clock::now();
+    vector<int> done;
+    for (auto& [fd, session] : this->sessions) {
+        if (session.closing && session.pending.empty() && session.out.empty() && this->net.queued(fd) == 0 && now >= session.linger_until) {
+            done.push_back(fd);
+        }
+    }
+    for (int fd : done) {
+        this->remove_session(fd);
+    }
+}
+
+
+void MockServer::print_stats() const {
+    fprintf(stderr, "STATS mockserver sessions=%llu received=%llu sent=%llu retransmissions=%llu confirms=%llu duplicates=%llu "
+        "malformed=%llu flood=%llu gave_up=%llu\n", (unsigned long long)this->sessions_total, (unsigned long long)this->received,
+        (unsigned long long)this->sent, (unsigned long long)this->retransmissions, (unsigned long long)this->confirms,
+        (unsigned long long)this->duplicates, (unsigned long long)this->malformed, (unsigned long long)this->flood_sent,
+        (unsigned long long)this->gave_up);
+    fprintf(stderr, "STATS network lost=%llu duplicated=%llu reordered=%llu\n", (unsigned long long)this->net.get_dropped(),
+        (unsigned long long)this->net.get_duplicated(), (unsigned long long)this->net.get_reordered());
+}
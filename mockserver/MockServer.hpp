@@ -0,0 +1,181 @@
+/**
+ * @file MockServer.hpp
+ * @brief MockServer class header
+ * 
+ * A local IPK24-CHAT server for testing and benchmarking the client without the reference server. Speaks 
+ * both variants on the same port, including the UDP handoff to a dynamically assigned port, and passes 
+ * the outgoing messages through the emulated network (Impairment).
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#ifndef MOCKSERVER_HPP
+#define MOCKSERVER_HPP
+
+#include "Impairment.hpp"
+#include "../Message.hpp"
+#include "../LineFramer.hpp"
+#include "../DuplicateFilter.hpp"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#define MOCK_DEFAULT_CHANNEL "default"
+#define MOCK_FLOOD_NAME "Flood" // display name of the flood messages
+#define MOCK_FLOOD_BACKLOG (1 << 20) // no flood to a TCP client with this many bytes unsent
+
+using namespace std;
+
+/**
+ * @brief Configuration of the mock server
+ */
+struct MockServerOptions {
+    int port;
+    int timeout_ms; // UDP confirmation timeout
+    int max_retransmissions; // UDP retransmissions before the client is considered gone
+    double flood_rate; // MSG messages per second sent to each authenticated client, 0 for none
+    uint64_t flood_count; // flood messages per client, 0 for no limit
+    bool verbose; // print every received message
+    ImpairmentOptions impairment;
+};
+
+/**
+ * @brief A message received from a client, the fields are views into the received data
+ */
+struct ClientMsg {
+    MessageType type;
+    uint16_t msgID; // UDP only
+    string_view fields[3]; // in the order of the message schema (e.g. username, display name, secret)
+};
+
+/**
+ * @class MockServer
+ * @brief Single-threaded server driven by one poll() loop
+ * 
+ * Every authenticated client is in a channel (MOCK_DEFAULT_CHANNEL after AUTH), MSG messages are relayed 
+ * to the other clients of the channel, joining and leaving is announced by the "Server". Outgoing UDP messages 
+ * are retransmitted until confirmed, incoming ones are confirmed and deduplicated by their message ID.
+ * 
+ */
+class MockServer {
+    using Clock = chrono::steady_clock;
+
+    /**
+     * @brief An outgoing UDP message awaiting its confirmation
+     */
+    struct Pending {
+        vector<uint8_t> data;
+        int retransmissions;
+        Clock::time_point deadline;
+    };
+
+    /**
+     * @brief A connected client, identified by its socket (TCP connection or the dynamic UDP socket)
+     */
+    struct Session {
+        bool udp = false;
+        int fd = -1;
+        struct sockaddr_in addr = {}; // UDP client address
+        unique_ptr<LineFramer> framer; // TCP receive buffer
+        string out; // TCP data not written yet
+
+        bool auth = false;
+        string display_name;
+        string channel;
+
+        uint16_t next_msgID = 0;
+        DuplicateFilter seen; // UDP message IDs received
+        map<uint16_t, Pending> pending;
+
+        double flood_credit = 0; // flood messages due
+        Clock::time_point last_flood; // when the flood credit was last added
+        uint64_t flooded = 0;
+
+        bool closing = false; // BYE was sent or received, closed once everything is delivered
+        Clock::time_point linger_until; // retransmitted messages of a closing UDP client are still confirmed
+    };
+
+    // retransmission timer: deadline, socket and message ID, earliest deadline on top
+    using Timer = tuple<Clock::time_point, int, uint16_t>;
+
+    MockServerOptions opts;
+    Impairment net;
+    int tcp_listen;
+    int udp_listen;
+    map<int, Session> sessions;
+    priority_queue<Timer, vector<Timer>, greater<Timer>> timers; // stale entries are skipped when they expire
+
+    // statistics
+    uint64_t sessions_total;
+    uint64_t received;
+    uint64_t sent;
+    uint64_t retransmissions;
+    uint64_t confirms;
+    uint64_t duplicates;
+    uint64_t malformed;
+    uint64_t flood_sent;
+    uint64_t gave_up; // UDP clients not confirming
+
+    void accept_tcp();
+    void receive_udp_listen();
+    void receive_udp(Session& session);
+    void receive_tcp(Session& session);
+    void handle_datagram(Session& session, span<const uint8_t> datagram);
+    void handle(Session& session, const ClientMsg& msg);
+
+    /**
+     * @brief Encode the message for the session's variant and schedule it, UDP messages get the next message ID
+     */
+    template <typename Msg>
+    void send_msg(Session& session, Msg msg);
+
+    void reply(Session& session, bool result, uint16_t ref_msgID, string_view content);
+    void announce(const string& channel, const Session* except, string_view display_name, string_view content);
+    void error(Session& session, string_view content);
+    void close_session(Session& session);
+    void remove_session(int fd);
+
+    void process_timeouts();
+    void flood();
+    void deliver();
+    void flush_tcp(Session& session);
+    void reap();
+    int next_timeout() const;
+
+    public:
+        /**
+         * @brief Construct a new MockServer object, listening on the TCP and UDP port
+         * 
+         * @param opts Configuration
+         */
+        MockServer(const MockServerOptions& opts);
+        ~MockServer();
+
+        MockServer(const MockServer&) = delete;
+        MockServer& operator=(const MockServer&) = delete;
+
+        /**
+         * @return true The sockets are listening
+         */
+        bool is_listening() const { return this->tcp_listen >= 0 && this->udp_listen >= 0; }
+
+        /**
+         * @brief Serve the clients until interrupted
+         * 
+         * @param interrupt Flag set by the signal handler
+         */
+        void run(const atomic<bool>& interrupt);
+
+        /**
+         * @brief Print the statistics of the run to stderr
+         */
+        void print_stats() const;
+};
+
+#endif // MOCKSERVER_HPP
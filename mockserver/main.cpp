@@ -0,0 +1,76 @@
+/**
+ * @file main.cpp
+ * @brief Entry point of the mock IPK24-CHAT server
+ * 
+ * Usage: ./ipk24chat-mockserver [-p port] [-l loss] [-o reorder] [-u duplication] [-d delay] [-f flood rate] 
+ *        [-n flood count] [-t UDP confirmation timeout] [-r max UDP retransmissions] [-s seed] [-v]
+ * 
+ * Serves until interrupted (SIGINT/SIGTERM), then prints its statistics to stderr.
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "MockServer.hpp"
+
+#include <csignal>
+#include <cstring>
+#include <cstdio>
+#include <unordered_map>
+
+atomic<bool> interrupt(false);
+
+void signal_handler(int) {
+    interrupt.store(true);
+}
+
+int main(int argc, char* argv[]) {
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    unordered_map<string, string> args = {
+        {"-p", "4567"}, // TCP and UDP port
+        {"-l", "0"},    // probability of losing a datagram
+        {"-o", "0"},    // probability of reordering an outgoing datagram
+        {"-u", "0"},    // probability of duplicating an outgoing datagram
+        {"-d", "0"},    // latency added to the outgoing messages (ms)
+        {"-f", "0"},    // flood rate (MSG messages per second to each client)
+        {"-n", "0"},    // flood messages per client, 0 for no limit
+        {"-t", "250"},  // UDP confirmation timeout (ms)
+        {"-r", "3"},    // maximum number of UDP retransmissions
+        {"-s", "1"}     // random seed of the emulated network
+    };
+    bool verbose = false; // -v flag, takes no value
+
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-h") == 0 || (strcmp(argv[i], "-v") != 0 && i + 1 >= argc)) {
+            printf("\nUsage:\n");
+            printf("\t./ipk24chat-mockserver [-p port] [-l loss] [-o reorder] [-u duplication] [-d delay ms] ");
+            printf("[-f flood rate] [-n flood count] [-t UDP confirmation timeout] [-r max UDP retransmissions] [-s seed] [-v]\n\n");
+            return EXIT_SUCCESS;
+        }
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+            i--; // no value
+            continue;
+        }
+        args[argv[i]] = argv[i + 1];
+    }
+
+    MockServerOptions opts;
+    opts.port = stoi(args["-p"]);
+    opts.timeout_ms = stoi(args["-t"]);
+    opts.max_retransmissions = stoi(args["-r"]);
+    opts.flood_rate = stod(args["-f"]);
+    opts.flood_count = stoull(args["-n"]);
+    opts.verbose = verbose;
+    opts.impairment = { stod(args["-l"]), stod(args["-o"]), stod(args["-u"]), stoi(args["-d"]), static_cast<unsigned>(stoul(args["-s"])) };
+
+    MockServer server(opts);
+    if (!server.is_listening()) {
+        return EXIT_FAILURE;
+    }
+    server.run(interrupt);
+    server.print_stats();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file trace_decode.cpp
+ * @brief Decoder of the trace dumps of the client built with -DIPK_TRACE
+ * 
+ * Prints one line per record: time since the first record, event, message ID, client state and the event argument.
+ * 
+ * Usage: ./ipk24chat-tracedecode [trace file] (ipk24chat.trace by default)
+ * 
+ * @author Adam Valík <xvalik05@vutbr.cz>
+ * 
+*/
+
+#include "../ClientState.hpp"
+#include "../Trace.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    const char* path = argc > 1 ? argv[1] : TRACE_FILE;
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "ERR: Cannot open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    TraceFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, "IPKTRACE", 8) != 0
+            || header.version != 1 || header.record_size != sizeof(TraceRecord)) {
+        fprintf(stderr, "ERR: %s is not a trace dump\n", path);
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    vector<TraceRecord> records(header.count);
+    size_t count = fread(records.data(), sizeof(TraceRecord), records.size(), file);
+    fclose(file);
+
+    printf("# %zu records", count);
+    if (header.recorded > count) {
+        printf(" (the first %llu were overwritten)", (unsigned long long)(header.recorded - count));
+    }
+    printf("\n");
+
+    uint64_t start = count > 0 ? records[0].timestamp : 0;
+    for (size_t i = 0; i < count; i++) {
+        const TraceRecord& record = records[i];
+        const char* event = record.event < static_cast<uint16_t>(TraceEvent::COUNT) ? TRACE_EVENT_NAMES[record.event] : "?";
+        const char* state = record.state < sizeof(CLIENT_STATE_NAMES) / sizeof(CLIENT_STATE_NAMES[0]) ? CLIENT_STATE_NAMES[record.state] : "-";
+        printf("%14.3f us  %-16s msgID=%-5u state=%-12s arg=%u\n", (record.timestamp - start) / 1e3, event, record.msgID, state, record.arg);
+    }
+    return EXIT_SUCCESS;
+}